@@ -5,32 +5,77 @@
 #ifndef DIFFIE_HELLMAN_H
 #define DIFFIE_HELLMAN_H
 
+#include <cstddef>
 #include <gmpxx.h>
+#include <memory>
+#include <span>
+#include <vector>
 
 
 /**
- * @brief A struct representing the Diffie-Hellman Ephemeral.
+ * @brief A struct representing the Diffie-Hellman Ephemeral over the RFC 7919 ffdhe2048 group.
  */
 struct diffie_hellman {
+    /// Private exponent size giving about twice the group's 112-bit security level (RFC 7919, section 5.2).
+    static constexpr size_t default_exponent_bits = 256;
+
     mpz_class K;
     const mpz_class p, g, x, y;
 
     /**
      * @brief Constructs a new diffie_hellman object and initializes the parameters.
+     *
+     * The private exponent x is drawn uniformly from [2, 2^exponent_bits). Since p is a safe prime, a short
+     * exponent is as strong as a full-size one up to half its length in bits, and it makes both exponentiations
+     * proportionally cheaper.
+     *
+     * @param exponent_bits The size of the private exponent in bits (less than the size of p).
      */
-    diffie_hellman();
+    explicit diffie_hellman(size_t exponent_bits = default_exponent_bits);
 
     /**
      * @brief Computes and sets the shared secret key from peer's public key.
      * @param pub_key The peer's public key.
      * @return The computed shared secret key.
+     * @throws std::invalid_argument If the public key fails validate_public_key().
      */
     mpz_class set_peer_public_key(const mpz_class &pub_key);
+
+    /**
+     * @brief Validates a peer's public key.
+     *
+     * The basic check is 1 < pub_key < p - 1 (RFC 7919, section 5.1), which rules out the subgroups of order 1 and
+     * 2; for a safe prime no other small subgroup exists. The full check additionally confirms that pub_key lies in
+     * the prime-order subgroup, i.e. pub_key^((p - 1) / 2) == 1, at the cost of one more exponentiation.
+     *
+     * @param pub_key The peer's public key.
+     * @param full Whether to also check membership in the prime-order subgroup.
+     * @return True if the public key is valid.
+     */
+    [[nodiscard]]
+    bool validate_public_key(const mpz_class &pub_key, bool full = false) const;
+};
+
+
+struct ec_point;
+
+
+/**
+ * @brief Elliptic curve point in Jacobian coordinates.
+ *
+ * (X : Y : Z) represents the affine point (X / Z^2, Y / Z^3); Z == 0 is the identity. Additions and doublings in
+ * this form need no modular inversion, so a scalar multiplication only inverts once when converting back to affine.
+ */
+struct ec_jacobian {
+    mpz_class X, Y, Z;
 };
 
 
 /**
  * @brief Represents an elliptic curve field defined by the equation y^2 = x^3 + ax + b (modulo with the given modulus).
+ *
+ * The parameters live in one immutable block shared by the field and every point on it, so copying a field or a
+ * point copies a reference rather than the numbers. The curves of ec_curves.h are built once and shared this way.
  */
 class ec_field {
 public:
@@ -42,8 +87,86 @@ public:
      */
     ec_field(const mpz_class &a, const mpz_class &b, const mpz_class &mod);
 
+    /**
+     * @brief Field arithmetic used for scalar multiplication on the curve.
+     *
+     * Curves over the P-256 and secp256k1 primes (with a = -3 and a = 0, respectively) run on fixed-size 4 x 64-bit
+     * limbs from fe256.h; every other curve uses mpz_class numbers.
+     */
+    enum class arithmetic : unsigned char {
+        generic, ///< mpz_class
+        p256, ///< fe256<p256_field>
+        secp256k1, ///< fe256<secp256k1_field>
+    };
+
+    /**
+     * @brief Returns the modulus of the field.
+     */
+    [[nodiscard]]
+    const mpz_class &modulus() const;
+
+    /**
+     * @brief Returns the arithmetic selected for this curve.
+     */
+    [[nodiscard]]
+    arithmetic field_arithmetic() const;
+
+    /**
+     * @brief Converts an affine point to Jacobian coordinates.
+     * @param p The affine point.
+     * @return The point with Z = 1 (or the identity).
+     */
+    [[nodiscard]]
+    ec_jacobian to_jacobian(const ec_point &p) const;
+
+    /**
+     * @brief Converts a point back to affine coordinates with one modular inversion.
+     * @param p The Jacobian point.
+     * @return The affine point.
+     */
+    [[nodiscard]]
+    ec_point to_affine(const ec_jacobian &p) const;
+
+    /**
+     * @brief Converts several points to affine coordinates with a single modular inversion (Montgomery's trick).
+     * @param p The Jacobian points.
+     * @return The affine points in the same order.
+     */
+    [[nodiscard]]
+    std::vector<ec_point> to_affine(std::span<const ec_jacobian> p) const;
+
+    /**
+     * @brief Doubles a point (dbl-2007-bl, with shortcuts for a = 0 and a = -3).
+     * @param[in,out] p The point to double.
+     */
+    void dbl(ec_jacobian &p) const;
+
+    /**
+     * @brief Adds a point (add-2007-bl).
+     * @param[in,out] p The augend; receives the sum.
+     * @param q The addend.
+     */
+    void add(ec_jacobian &p, const ec_jacobian &q) const;
+
+    /**
+     * @brief Adds an affine point (madd-2007-bl), which saves the multiplications by Z2.
+     * @param[in,out] p The augend; receives the sum.
+     * @param q The affine addend.
+     */
+    void add(ec_jacobian &p, const ec_point &q) const;
+
 protected:
-    mpz_class a, b, mod;
+    /// The curve parameters.
+    struct params {
+        mpz_class a, b, mod;
+        bool a_is_zero, a_is_minus_3; ///< Curve shapes with cheaper doubling
+        arithmetic arith;
+
+        /// Stores the coefficients and detects the curve shape and its arithmetic.
+        params(const mpz_class &a, const mpz_class &b, const mpz_class &mod);
+    };
+
+    std::shared_ptr<const params> curve;
 
     /**
      * @brief Computes the modular inverse of a given value.
@@ -56,7 +179,7 @@ protected:
 
 
 /**
- * @brief Represents a point on an elliptic curve.
+ * @brief Represents a point on an elliptic curve: its coordinates and a reference to the shared curve parameters.
  */
 struct ec_point : ec_field {
     mpz_class x, y;
@@ -95,8 +218,35 @@ struct ec_point : ec_field {
      */
     bool operator==(const ec_point &r) const;
 
+    /**
+     * @brief Negates the point.
+     * @return The point (x, -y).
+     */
+    ec_point operator-() const;
+
+    /**
+     * @brief Multiplies the point by a secret scalar with a fixed operation sequence.
+     *
+     * The scalar is recoded into odd signed digits of w = 4 bits (Joye-Tunstall), so every window costs exactly w
+     * doublings and one addition of a multiple read from the table with mpn_sec_tabselect(), independent of the
+     * scalar's value. The schedule and the memory access pattern therefore depend only on bits. The fixed-limb field
+     * arithmetic of P-256 and secp256k1 is branch-free as well; the mpz arithmetic of other curves is not. The order
+     * of the point must exceed 2^w.
+     *
+     * @param k The scalar in [0, 2^bits).
+     * @param bits Upper bound on the bit length of the scalar (e.g., that of the group order).
+     * @return k * *this.
+     */
+    [[nodiscard]]
+    ec_point mul_secret(const mpz_class &k, size_t bits) const;
+
     /**
      * @brief Multiplies an elliptic curve point by a scalar.
+     *
+     * Recodes the scalar into width-w NAF straight from its limbs and adds odd multiples of the point from a small
+     * table, in Jacobian coordinates with a single inversion at the end. The running time depends on the scalar;
+     * use mul_secret() for secret scalars.
+     *
      * @param l The scalar to multiply by.
      * @param p The point to multiply.
      * @return The result of the multiplication.
@@ -110,6 +260,160 @@ struct ec_point : ec_field {
      * @return The output stream with the point's coordinates written to it.
      */
     friend std::ostream &operator<<(std::ostream &os, const ec_point &r);
+
+    friend class ec_fixed_base;
+};
+
+
+/**
+ * @brief Affine odd multiples P, 3P, ..., (2^(w - 1) - 1)P and their negations, as used by width-w NAF.
+ *
+ * A table for a point that is used repeatedly (such as a generator) can be built once with a large width and
+ * passed to mul_add(). On curves with fixed-limb arithmetic (P-256, secp256k1) the table also keeps the odd
+ * multiples in that representation, so mul_add() uses them without converting them again.
+ */
+class ec_wnaf_table {
+public:
+    /**
+     * @brief Builds the table.
+     * @param p The point.
+     * @param w The NAF width (at least 2); the table holds 2^(w - 2) points and their negations.
+     */
+    ec_wnaf_table(const ec_point &p, unsigned w);
+
+    /**
+     * @brief Returns the NAF width.
+     */
+    [[nodiscard]]
+    unsigned width() const;
+
+    /**
+     * @brief Returns digit * P for a non-zero odd NAF digit.
+     * @param digit The digit, with |digit| < 2^(w - 1).
+     */
+    const ec_point &operator[](int digit) const;
+
+    /**
+     * @brief Returns the point the table was built for.
+     */
+    [[nodiscard]]
+    const ec_point &point() const;
+
+protected:
+    ec_point p;
+    unsigned w;
+    std::vector<ec_point> pos, neg; ///< pos[i] = (2i + 1)P, neg[i] = -(2i + 1)P
+    std::shared_ptr<const void> fixed; ///< The same table in fixed-limb arithmetic, if the curve has it
+
+    friend struct ec_wnaf_table_access;
+};
+
+
+/**
+ * @brief Computes u * P + v * Q with one shared doubling chain (Shamir's trick with interleaved width-w NAF).
+ *
+ * Both scalars are recoded separately and their digits are added from the respective tables while a single
+ * accumulator is doubled, so the cost is one doubling per bit of the longer scalar plus the non-zero digits of
+ * both. Scalars that are not positive contribute nothing.
+ *
+ * @param u The scalar for P.
+ * @param p The odd multiples of P.
+ * @param v The scalar for Q.
+ * @param q The odd multiples of Q (on the same curve).
+ * @return u * P + v * Q.
+ */
+[[nodiscard]]
+ec_point mul_add(const mpz_class &u, const ec_wnaf_table &p, const mpz_class &v, const ec_wnaf_table &q);
+
+/**
+ * @brief Computes u * P + v * Q like mul_add() but leaves the result in Jacobian coordinates, for callers that
+ * normalize several results with one batched inversion.
+ */
+[[nodiscard]]
+ec_jacobian mul_add_jacobian(const mpz_class &u, const ec_wnaf_table &p, const mpz_class &v, const ec_wnaf_table &q);
+
+/**
+ * @brief Computes u * P + v * Q for a precomputed P and a width-5 table of Q built on the fly.
+ */
+[[nodiscard]]
+ec_point mul_add(const mpz_class &u, const ec_wnaf_table &p, const mpz_class &v, const ec_point &q);
+
+/**
+ * @brief Computes u * P + v * Q like mul_add() with an on-the-fly table of Q, in Jacobian coordinates.
+ */
+[[nodiscard]]
+ec_jacobian mul_add_jacobian(const mpz_class &u, const ec_wnaf_table &p, const mpz_class &v, const ec_point &q);
+
+/**
+ * @brief Computes u * P + v * Q with width-5 tables built on the fly.
+ */
+[[nodiscard]]
+ec_point mul_add(const mpz_class &u, const ec_point &p, const mpz_class &v, const ec_point &q);
+
+
+/**
+ * @brief Precomputed multiples of a fixed point for scalar multiplication without doublings.
+ *
+ * The scalar is recoded into odd signed digits of w = 4 bits as in ec_point::mul_secret(), and every window i has
+ * its own table of the odd multiples (2j + 1) * 2^(w * i) * P. A multiplication is then one constant-time table
+ * lookup and one mixed addition per window, about bits / 4 additions in total. The table is immutable once built,
+ * so one instance can be shared by any number of threads.
+ */
+class ec_fixed_base {
+public:
+    /**
+     * @brief Builds the table.
+     * @param p The fixed point (of order greater than 2^w).
+     * @param bits The largest scalar size the table covers (e.g., that of the group order).
+     */
+    ec_fixed_base(const ec_point &p, size_t bits);
+
+    /**
+     * @brief Computes k * p.
+     * @param k The scalar in [0, 2^bits).
+     * @return k * p.
+     */
+    [[nodiscard]]
+    ec_point operator()(const mpz_class &k) const;
+
+    /**
+     * @brief Computes k * p like operator() but leaves the result in Jacobian coordinates, for callers that
+     * normalize several results with one batched inversion.
+     */
+    [[nodiscard]]
+    ec_jacobian jacobian(const mpz_class &k) const;
+
+protected:
+    static constexpr unsigned window = 4; ///< Window size in bits
+    static constexpr size_t entries = size_t{1} << (window - 1); ///< Odd multiples per window
+
+    ec_point p;
+    size_t windows; ///< Number of windows
+    size_t n; ///< Limbs per coordinate
+    std::vector<mp_limb_t> table; ///< Affine (x, y) limb pairs in the curve's arithmetic, entries per window
+
+private:
+    /**
+     * @brief Runs the multiplication and hands the Jacobian result to finish together with the curve adapter.
+     */
+    template<class Finish>
+    auto multiply(const mpz_class &k, Finish &&finish) const;
+};
+
+
+/**
+ * @brief Ephemeral elliptic curve keypair.
+ */
+struct ec_keypair {
+    mpz_class d; ///< Private key in [1, n - 1]
+    ec_point Q; ///< Public key d * G
+
+    /**
+     * @brief Generates a random keypair.
+     * @param G The generator point.
+     * @param n The order of the generator.
+     */
+    ec_keypair(const ec_point &G, const mpz_class &n);
 };
 
 
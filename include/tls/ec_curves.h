@@ -0,0 +1,52 @@
+//
+// Created by wtchr on 10/19/2026.
+//
+
+#ifndef EC_CURVES_H
+#define EC_CURVES_H
+
+#include <gmpxx.h>
+#include <string_view>
+#include "diffie_hellman.h"
+
+
+/**
+ * @brief A named elliptic curve: its field, generator and group order.
+ *
+ * The parameters are stored as constexpr limb arrays and converted once, on first use, without parsing any strings.
+ * Each curve is built a single time and shared: G and every point derived from it refer to the same immutable field
+ * parameters, so copying a point copies only its coordinates.
+ */
+struct named_curve {
+    const char *name; ///< Standard name, e.g. "P-256"
+    ec_field field; ///< The curve y^2 = x^3 + ax + b over its prime field
+    ec_point G; ///< The generator
+    mpz_class n; ///< The order of G
+
+    /**
+     * @brief Returns NIST P-256 (secp256r1), which uses the fixed-limb Montgomery arithmetic of fe256.h.
+     */
+    static const named_curve &p256();
+
+    /**
+     * @brief Returns NIST P-384 (secp384r1).
+     */
+    static const named_curve &p384();
+
+    /**
+     * @brief Returns secp256k1, which uses the fixed-limb arithmetic of fe256.h.
+     */
+    static const named_curve &secp256k1();
+
+    /**
+     * @brief Looks up a curve by its standard or SEC name ("P-256", "secp256r1", "P-384", "secp384r1",
+     * "secp256k1").
+     * @param name The name of the curve.
+     * @return The curve, or nullptr if the name is unknown.
+     */
+    [[nodiscard]]
+    static const named_curve *find(std::string_view name);
+};
+
+
+#endif
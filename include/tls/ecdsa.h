@@ -5,8 +5,16 @@
 #ifndef ECDSA_H
 #define ECDSA_H
 
+#include <algorithm>
+#include <array>
 #include <gmpxx.h>
+#include <span>
+#include <vector>
 #include "diffie_hellman.h"
+#include "ec_curves.h"
+#include "hmac.h"
+#include "keypair_pool.h"
+#include "mpz.h"
 
 
 /**
@@ -16,13 +24,42 @@
  */
 class ecdsa_class : public ec_point {
 public:
+    /**
+     * @brief One entry of a verification batch.
+     */
+    struct signed_message {
+        mpz_class m; ///< The message, as for verify()
+        std::pair<mpz_class, mpz_class> sig; ///< The signature (r, s)
+        ec_point Q; ///< The public key
+    };
+
+    /**
+     * @brief The message-independent part of a signature: r = (k * G).x mod n and k^-1 mod n for a random nonce k.
+     *
+     * A presignature is as secret as the nonce itself and must be used for one signature only.
+     */
+    struct presignature {
+        mpz_class k_inv; ///< The inverse of the nonce modulo n
+        mpz_class r; ///< The first signature component
+    };
+
     /**
      * @brief Constructs an ECDSA object with the given generator point and order.
+     *
+     * Also builds the fixed-base table of G used for k * G when signing and the width-8 NAF table of G used by
+     * verification.
+     *
      * @param G The generator point on the elliptic curve.
      * @param n The order of the generator point.
      */
     ecdsa_class(const ec_point &G, mpz_class n);
 
+    /**
+     * @brief Constructs an ECDSA object for a named curve.
+     * @param curve The curve, e.g. named_curve::p256().
+     */
+    explicit ecdsa_class(const named_curve &curve);
+
     /**
      * @brief Computes the modular inverse of a given value.
      * @param z The value to compute the modular inverse of.
@@ -33,6 +70,10 @@ public:
 
     /**
      * @brief Signs a message using the private key.
+     *
+     * The nonce k is drawn uniformly from [1, n - 1] with random_below(), which reads the buffered per-thread
+     * generator of random.h.
+     *
      * @param m The message to sign.
      * @param d The private key.
      * @return A pair containing the signature components (r, s).
@@ -40,6 +81,34 @@ public:
     [[nodiscard]]
     std::pair<mpz_class, mpz_class> sign(const mpz_class &m, const mpz_class &d) const;
 
+    /**
+     * @brief Computes a presignature for a uniformly random nonce.
+     */
+    [[nodiscard]]
+    presignature presign() const;
+
+    /**
+     * @brief Computes several presignatures at once.
+     *
+     * The points k_i * G are kept in Jacobian coordinates and normalized with one field inversion, and all k_i are
+     * inverted modulo n with one more (Montgomery's trick), so a batch costs two inversions in total.
+     *
+     * @param count The number of presignatures.
+     * @return The presignatures.
+     */
+    [[nodiscard]]
+    std::vector<presignature> presign(size_t count) const;
+
+    /**
+     * @brief Signs a message with a presignature: s = k^-1 (z + r d) mod n.
+     * @param m The message to sign.
+     * @param d The private key.
+     * @param pre A presignature that has not been used before.
+     * @return A pair containing the signature components (r, s).
+     */
+    [[nodiscard]]
+    std::pair<mpz_class, mpz_class> sign(const mpz_class &m, const mpz_class &d, const presignature &pre) const;
+
     /**
      * @brief Verifies a signature for a given message and public key.
      * @param m The message to verify.
@@ -50,12 +119,198 @@ public:
     [[nodiscard]]
     bool verify(const mpz_class &m, const std::pair<mpz_class, mpz_class> &sig, const ec_point &Q) const;
 
+    /**
+     * @brief Signs a message digest using the private key.
+     * @param digest The message digest; only its leftmost bits up to the bit length of n are used.
+     * @param d The private key.
+     * @return A pair containing the signature components (r, s).
+     */
+    [[nodiscard]]
+    std::pair<mpz_class, mpz_class> sign(std::span<const unsigned char> digest, const mpz_class &d) const;
+
+    /**
+     * @brief Signs a message digest with a deterministic nonce (RFC 6979, section 3.2).
+     *
+     * The nonce is derived from the private key and the digest with HMAC_DRBG, so signing needs no randomness
+     * and the same message and key always give the same signature.
+     *
+     * @tparam Hash The hash function that produced the digest (e.g., sha256); it also instantiates the HMAC.
+     * @param digest The message digest; only its leftmost bits up to the bit length of n are used.
+     * @param d The private key in [1, n - 1].
+     * @return A pair containing the signature components (r, s).
+     */
+    template<HashFunction Hash>
+    [[nodiscard]]
+    std::pair<mpz_class, mpz_class> sign_deterministic(std::span<const unsigned char> digest,
+                                                       const mpz_class &d) const;
+
+    /**
+     * @brief Verifies a signature for a given message digest and public key.
+     * @param digest The message digest; only its leftmost bits up to the bit length of n are used.
+     * @param sig The signature to verify, represented as a pair (r, s).
+     * @param Q The public key.
+     * @return True if the signature is valid, false otherwise.
+     */
+    [[nodiscard]]
+    bool verify(std::span<const unsigned char> digest, const std::pair<mpz_class, mpz_class> &sig,
+                const ec_point &Q) const;
+
+    /**
+     * @brief Verifies a batch of signatures, sharing work across the entries.
+     *
+     * The inverses of all s are computed with one modular inversion (Montgomery's trick), each u * G + v * Q is
+     * evaluated with mul_add() but left in Jacobian coordinates, and all points are normalized with one more
+     * inversion.
+     *
+     * @param batch The entries to verify.
+     * @return For each entry, whether its signature is valid.
+     */
+    [[nodiscard]]
+    std::vector<bool> verify_batch(std::span<const signed_message> batch) const;
+
 protected:
     mpz_class n; ///< The order of the generator point.
+    ec_fixed_base g_table; ///< Precomputed multiples of the generator point.
+    ec_wnaf_table g_wnaf; ///< Odd multiples of the generator point for mul_add().
 
 private:
     size_t n_bit;
+
+    /**
+     * @brief Computes a signature with a given nonce.
+     * @param z The truncated message.
+     * @param d The private key.
+     * @param k The nonce in [1, n - 1].
+     * @param[out] sig Receives the signature (r, s).
+     * @return False if r or s is zero, in which case another nonce must be tried.
+     */
+    bool sign_with(const mpz_class &z, const mpz_class &d, const mpz_class &k,
+                   std::pair<mpz_class, mpz_class> &sig) const;
+
+    /**
+     * @brief Computes s from a presignature.
+     * @return False if s is zero, in which case another nonce must be tried.
+     */
+    bool sign_with(const mpz_class &z, const mpz_class &d, const presignature &pre,
+                   std::pair<mpz_class, mpz_class> &sig) const;
+
+    /**
+     * @brief Inverts several non-zero numbers modulo n with one inversion (Montgomery's trick).
+     * @param a The numbers, reduced modulo n.
+     * @return The inverses, in the same order.
+     */
+    [[nodiscard]]
+    std::vector<mpz_class> batch_inverse(std::span<const mpz_class> a) const;
+
+    /**
+     * @brief Keeps the leftmost n_bit bits of a message that is too big.
+     * @param m The message.
+     * @return The integer z used in signing and verification.
+     */
+    [[nodiscard]]
+    mpz_class truncate(const mpz_class &m) const;
+
+    /**
+     * @brief Converts a digest to an integer, keeping its leftmost n_bit bits.
+     * @param digest The message digest.
+     * @return The integer z used in signing and verification.
+     */
+    [[nodiscard]]
+    mpz_class bits2int(std::span<const unsigned char> digest) const;
+};
+
+
+/**
+ * @brief Pool of ECDSA presignatures computed ahead of time on background threads.
+ *
+ * Producers fill a keypair_pool with batches of ecdsa_class::presign(), so signing from the pool costs a single
+ * multiply-add modulo n; when the pool runs dry, sign() computes the presignature inline.
+ */
+class ecdsa_presign_pool {
+public:
+    /**
+     * @brief Constructs the pool and starts the background threads.
+     * @param ecdsa The signer; it must outlive the pool.
+     * @param low_watermark Producers resume when fewer presignatures than this are ready.
+     * @param high_watermark Producers pause when this many presignatures are ready.
+     * @param threads The number of background threads.
+     * @param batch The number of presignatures computed together by a producer.
+     */
+    ecdsa_presign_pool(const ecdsa_class &ecdsa, size_t low_watermark, size_t high_watermark, unsigned threads = 1,
+                       size_t batch = 16);
+
+    /**
+     * @brief Signs a message with a presignature from the pool.
+     * @param m The message to sign.
+     * @param d The private key.
+     * @return A pair containing the signature components (r, s).
+     */
+    [[nodiscard]]
+    std::pair<mpz_class, mpz_class> sign(const mpz_class &m, const mpz_class &d);
+
+    /**
+     * @brief Returns a snapshot of the usage statistics.
+     */
+    [[nodiscard]]
+    keypair_pool<ecdsa_class::presignature>::statistics stats() const;
+
+private:
+    const ecdsa_class &ecdsa;
+    keypair_pool<ecdsa_class::presignature> pool;
 };
 
 
+template<HashFunction Hash>
+std::pair<mpz_class, mpz_class> ecdsa_class::sign_deterministic(
+        const std::span<const unsigned char> digest, const mpz_class &d
+) const {
+    const size_t rlen = (n_bit + 7) / 8;
+    const mpz_class z = bits2int(digest);
+
+    // int2octets(x) || bits2octets(h1), preceded by a separator byte in steps d and f.
+    std::vector<unsigned char> seed(1 + 2 * rlen);
+    mpz2bnd(d, std::span{seed}.subspan(1, rlen));
+    mpz2bnd(z % n, std::span{seed}.subspan(1 + rlen));
+
+    std::array<unsigned char, Hash::output_size> V, K;
+    V.fill(0x01);
+    K.fill(0x00);
+    hmac<Hash> mac;
+    // K = HMAC_K(V || data), then V = HMAC_K(V).
+    const auto rekey = [&](const unsigned char *data, const size_t size) {
+        mac.key(K.begin(), K.end());
+        mac.update(V.begin(), V.end());
+        mac.update(data, data + size);
+        K = mac.digest();
+        mac.key(K.begin(), K.end());
+        V = mac.hash(V.begin(), V.end());
+    };
+    seed[0] = 0x00;
+    rekey(seed.data(), seed.size());
+    seed[0] = 0x01;
+    rekey(seed.data(), seed.size());
+
+    std::vector<unsigned char> T;
+    T.reserve(rlen + Hash::output_size);
+    std::pair<mpz_class, mpz_class> sig;
+    while (true) {
+        T.clear();
+        while (T.size() < rlen) {
+            V = mac.hash(V.begin(), V.end());
+            T.insert(T.end(), V.begin(), V.end());
+        }
+        const mpz_class k = bits2int(T);
+        if (k >= 1 && k < n && sign_with(z, d, k, sig))
+            break;
+        constexpr unsigned char zero = 0x00;
+        rekey(&zero, 1);
+    }
+    std::fill(seed.begin(), seed.end(), 0);
+    std::fill(T.begin(), T.end(), 0);
+    K.fill(0);
+    V.fill(0);
+    return sig;
+}
+
+
 #endif
@@ -0,0 +1,97 @@
+//
+// Created by wtchr on 10/19/2026.
+//
+
+#ifndef ED25519_H
+#define ED25519_H
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+
+/**
+ * @brief Represents an Ed25519 signing key (RFC 8032).
+ *
+ * Points are kept in extended twisted Edwards coordinates over the field of fe25519.h. Signing multiplies the base
+ * point with a precomputed radix-16 table: one constant-time lookup and one mixed addition per 4-bit window, and no
+ * doublings. Verification uses interleaved width-w NAF with a static table of odd multiples of the base point.
+ *
+ * Verification is cofactored: it accepts exactly the signatures with 8 * ([S]B - R - [k]A) = 0, so single and
+ * batch verification always agree.
+ */
+class ed25519 {
+public:
+    static constexpr size_t key_size = 32;
+    static constexpr size_t signature_size = 64;
+    using key_type = std::array<unsigned char, key_size>;
+    using signature_type = std::array<unsigned char, signature_size>;
+
+    /**
+     * @brief One entry of a verification batch.
+     */
+    struct signed_message {
+        std::span<const unsigned char> message; ///< The signed message
+        signature_type sig; ///< The signature (R, S)
+        key_type public_key; ///< The public key
+    };
+
+    /**
+     * @brief Constructs a signing key from a random private key.
+     */
+    ed25519();
+
+    /**
+     * @brief Constructs a signing key from a given private key.
+     * @param private_key The 32-byte private key (seed).
+     */
+    explicit ed25519(std::span<const unsigned char, key_size> private_key);
+
+    /**
+     * @brief Returns the encoded public key.
+     */
+    [[nodiscard]]
+    const key_type &public_key() const;
+
+    /**
+     * @brief Signs a message.
+     * @param message The message.
+     * @return The signature (R, S).
+     */
+    [[nodiscard]]
+    signature_type sign(std::span<const unsigned char> message) const;
+
+    /**
+     * @brief Verifies a signature for a given message and public key.
+     * @param message The message.
+     * @param sig The signature (R, S).
+     * @param public_key The encoded public key.
+     * @return True if the signature is valid, false otherwise (including malformed points and S >= L).
+     */
+    [[nodiscard]]
+    static bool verify(std::span<const unsigned char> message, std::span<const unsigned char, signature_size> sig,
+                       std::span<const unsigned char, key_size> public_key);
+
+    /**
+     * @brief Verifies several signatures at once.
+     *
+     * Each equation is weighted by a random 128-bit z_i, and the sum (-sum z_i S_i) B + sum z_i R_i +
+     * sum (z_i k_i) A_i is evaluated with one doubling chain shared by all points. A batch with an invalid
+     * signature fails that check except with probability about 2^-128, and then every entry is verified on its
+     * own to find the bad ones.
+     *
+     * @param batch The signatures to verify.
+     * @return For each entry, whether verify() would accept it.
+     */
+    [[nodiscard]]
+    static std::vector<bool> verify_batch(std::span<const signed_message> batch);
+
+protected:
+    key_type a; ///< Clamped secret scalar
+    key_type prefix; ///< Second half of the hashed private key, used to derive nonces
+    key_type A; ///< Encoded public key
+};
+
+
+#endif
@@ -0,0 +1,308 @@
+//
+// Created by wtchr on 10/19/2026.
+//
+
+#ifndef FE25519_H
+#define FE25519_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+
+/**
+ * @brief Element of the field of integers modulo p = 2^255 - 19, in five 51-bit limbs.
+ *
+ * Limbs are unsigned 64-bit words holding 51 bits plus a few bits of headroom, so sums need no carries and the 128-bit
+ * products of a multiplication can be accumulated directly; 2^255 = 19 (mod p) folds the upper half back. Every
+ * operation runs the same instructions whatever the values, which makes the type suitable for secret data.
+ */
+struct fe25519 {
+    static constexpr uint64_t mask = (uint64_t{1} << 51) - 1;
+
+    std::array<uint64_t, 5> v{}; ///< Limbs, least significant first
+
+    /**
+     * @brief Returns the element 1.
+     */
+    static fe25519 one();
+
+    /**
+     * @brief Decodes 32 little-endian bytes; the top bit is ignored and values up to 2^255 - 1 are accepted.
+     */
+    static fe25519 from_bytes(const unsigned char *in);
+
+    /**
+     * @brief Encodes the fully reduced element as 32 little-endian bytes.
+     */
+    void to_bytes(unsigned char *out) const;
+
+    /**
+     * @brief Checks whether the element is zero (in constant time).
+     */
+    [[nodiscard]]
+    bool is_zero() const;
+
+    /**
+     * @brief Returns the lowest bit of the fully reduced element (the "sign" of Ed25519).
+     */
+    [[nodiscard]]
+    bool is_negative() const;
+
+    fe25519 operator+(const fe25519 &r) const;
+    fe25519 operator-(const fe25519 &r) const;
+    fe25519 operator-() const;
+    fe25519 operator*(const fe25519 &r) const;
+
+    /**
+     * @brief Multiplies by a small constant.
+     * @param c The constant (less than 2^32).
+     */
+    [[nodiscard]]
+    fe25519 mul_small(uint32_t c) const;
+
+    /**
+     * @brief Returns the square of the element.
+     */
+    [[nodiscard]]
+    fe25519 sqr() const;
+
+    /**
+     * @brief Returns the element squared n times (a^(2^n)).
+     */
+    [[nodiscard]]
+    fe25519 sqr(int n) const;
+
+    /**
+     * @brief Returns the inverse a^(p - 2); the inverse of 0 is 0.
+     */
+    [[nodiscard]]
+    fe25519 inv() const;
+
+    /**
+     * @brief Returns a^((p - 5) / 8) = a^(2^252 - 3), the exponent used by square roots modulo p.
+     */
+    [[nodiscard]]
+    fe25519 pow22523() const;
+
+    /**
+     * @brief Swaps two elements if bit is set, without branching on it.
+     * @param a The first element.
+     * @param b The second element.
+     * @param bit 0 or 1.
+     */
+    static void cswap(fe25519 &a, fe25519 &b, uint64_t bit);
+
+private:
+    // Propagates carries so that every limb is below 2^51 + 2^13.
+    void carry();
+
+    // Shared addition chain of inv() and pow22523(): returns a^(2^250 - 1) and a^11.
+    void pow2250(fe25519 &t250, fe25519 &t11) const;
+};
+
+
+inline fe25519 fe25519::one() {
+    fe25519 r;
+    r.v[0] = 1;
+    return r;
+}
+
+inline fe25519 fe25519::from_bytes(const unsigned char *in) {
+    uint64_t w[4];
+    for (int i = 0; i < 4; ++i) {
+        w[i] = 0;
+        for (int j = 7; j >= 0; --j)
+            w[i] = w[i] << 8 | in[8 * i + j];
+    }
+    fe25519 r;
+    r.v[0] = w[0] & mask;
+    r.v[1] = (w[0] >> 51 | w[1] << 13) & mask;
+    r.v[2] = (w[1] >> 38 | w[2] << 26) & mask;
+    r.v[3] = (w[2] >> 25 | w[3] << 39) & mask;
+    r.v[4] = w[3] >> 12 & mask;
+    return r;
+}
+
+inline void fe25519::to_bytes(unsigned char *out) const {
+    fe25519 t = *this;
+    t.carry();
+    t.carry();
+    // Now t < 2^255 + 19 * 2^13; q = 1 exactly when t >= p, found by propagating the carry of t + 19.
+    uint64_t q = (t.v[0] + 19) >> 51;
+    for (int i = 1; i < 5; ++i)
+        q = (t.v[i] + q) >> 51;
+    t.v[0] += 19 * q;
+    for (int i = 0; i < 4; ++i) {
+        t.v[i + 1] += t.v[i] >> 51;
+        t.v[i] &= mask;
+    }
+    t.v[4] &= mask;
+
+    const uint64_t w[4] = {
+            t.v[0] | t.v[1] << 51, t.v[1] >> 13 | t.v[2] << 38, t.v[2] >> 26 | t.v[3] << 25, t.v[3] >> 39 | t.v[4] << 12
+    };
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 8; ++j)
+            out[8 * i + j] = static_cast<unsigned char>(w[i] >> (8 * j));
+}
+
+inline bool fe25519::is_zero() const {
+    unsigned char b[32];
+    to_bytes(b);
+    unsigned char acc = 0;
+    for (const unsigned char c : b)
+        acc |= c;
+    return acc == 0;
+}
+
+inline bool fe25519::is_negative() const {
+    unsigned char b[32];
+    to_bytes(b);
+    return b[0] & 1;
+}
+
+inline void fe25519::carry() {
+    for (int i = 0; i < 4; ++i) {
+        v[i + 1] += v[i] >> 51;
+        v[i] &= mask;
+    }
+    v[0] += 19 * (v[4] >> 51);
+    v[4] &= mask;
+}
+
+inline fe25519 fe25519::operator+(const fe25519 &r) const {
+    fe25519 s;
+    for (int i = 0; i < 5; ++i)
+        s.v[i] = v[i] + r.v[i];
+    s.carry();
+    return s;
+}
+
+inline fe25519 fe25519::operator-(const fe25519 &r) const {
+    // Adding 4p keeps every limb positive for operands below 2^53.
+    constexpr uint64_t four_p0 = 4 * (mask - 18), four_pi = 4 * mask;
+    fe25519 s;
+    s.v[0] = v[0] + four_p0 - r.v[0];
+    for (int i = 1; i < 5; ++i)
+        s.v[i] = v[i] + four_pi - r.v[i];
+    s.carry();
+    return s;
+}
+
+inline fe25519 fe25519::operator-() const {
+    return fe25519{} - *this;
+}
+
+inline fe25519 fe25519::operator*(const fe25519 &r) const {
+    using u128 = unsigned __int128;
+    const uint64_t *a = v.data(), *b = r.v.data();
+    // Limbs of b premultiplied by 19 for the products that wrap past 2^255.
+    const uint64_t b1 = 19 * b[1], b2 = 19 * b[2], b3 = 19 * b[3], b4 = 19 * b[4];
+    u128 t[5];
+    t[0] = static_cast<u128>(a[0]) * b[0] + static_cast<u128>(a[1]) * b4 + static_cast<u128>(a[2]) * b3 +
+           static_cast<u128>(a[3]) * b2 + static_cast<u128>(a[4]) * b1;
+    t[1] = static_cast<u128>(a[0]) * b[1] + static_cast<u128>(a[1]) * b[0] + static_cast<u128>(a[2]) * b4 +
+           static_cast<u128>(a[3]) * b3 + static_cast<u128>(a[4]) * b2;
+    t[2] = static_cast<u128>(a[0]) * b[2] + static_cast<u128>(a[1]) * b[1] + static_cast<u128>(a[2]) * b[0] +
+           static_cast<u128>(a[3]) * b4 + static_cast<u128>(a[4]) * b3;
+    t[3] = static_cast<u128>(a[0]) * b[3] + static_cast<u128>(a[1]) * b[2] + static_cast<u128>(a[2]) * b[1] +
+           static_cast<u128>(a[3]) * b[0] + static_cast<u128>(a[4]) * b4;
+    t[4] = static_cast<u128>(a[0]) * b[4] + static_cast<u128>(a[1]) * b[3] + static_cast<u128>(a[2]) * b[2] +
+           static_cast<u128>(a[3]) * b[1] + static_cast<u128>(a[4]) * b[0];
+
+    fe25519 s;
+    for (int i = 0; i < 4; ++i) {
+        t[i + 1] += static_cast<uint64_t>(t[i] >> 51);
+        s.v[i] = static_cast<uint64_t>(t[i]) & mask;
+    }
+    s.v[4] = static_cast<uint64_t>(t[4]) & mask;
+    s.v[0] += 19 * static_cast<uint64_t>(t[4] >> 51);
+    s.v[1] += s.v[0] >> 51;
+    s.v[0] &= mask;
+    return s;
+}
+
+inline fe25519 fe25519::mul_small(const uint32_t c) const {
+    using u128 = unsigned __int128;
+    fe25519 s;
+    u128 acc = 0;
+    for (int i = 0; i < 5; ++i) {
+        acc += static_cast<u128>(v[i]) * c;
+        s.v[i] = static_cast<uint64_t>(acc) & mask;
+        acc >>= 51;
+    }
+    s.v[0] += 19 * static_cast<uint64_t>(acc);
+    s.v[1] += s.v[0] >> 51;
+    s.v[0] &= mask;
+    return s;
+}
+
+inline fe25519 fe25519::sqr() const {
+    using u128 = unsigned __int128;
+    const uint64_t *a = v.data();
+    const uint64_t d0 = 2 * a[0], d1 = 2 * a[1], d2 = 2 * a[2];
+    const uint64_t a3_19 = 19 * a[3], a4_19 = 19 * a[4];
+    u128 t[5];
+    t[0] = static_cast<u128>(a[0]) * a[0] + static_cast<u128>(d1) * a4_19 + static_cast<u128>(2 * a[2]) * a3_19;
+    t[1] = static_cast<u128>(d0) * a[1] + static_cast<u128>(d2) * a4_19 + static_cast<u128>(a[3]) * a3_19;
+    t[2] = static_cast<u128>(d0) * a[2] + static_cast<u128>(a[1]) * a[1] + static_cast<u128>(2 * a[3]) * a4_19;
+    t[3] = static_cast<u128>(d0) * a[3] + static_cast<u128>(d1) * a[2] + static_cast<u128>(a[4]) * a4_19;
+    t[4] = static_cast<u128>(d0) * a[4] + static_cast<u128>(d1) * a[3] + static_cast<u128>(a[2]) * a[2];
+
+    fe25519 s;
+    for (int i = 0; i < 4; ++i) {
+        t[i + 1] += static_cast<uint64_t>(t[i] >> 51);
+        s.v[i] = static_cast<uint64_t>(t[i]) & mask;
+    }
+    s.v[4] = static_cast<uint64_t>(t[4]) & mask;
+    s.v[0] += 19 * static_cast<uint64_t>(t[4] >> 51);
+    s.v[1] += s.v[0] >> 51;
+    s.v[0] &= mask;
+    return s;
+}
+
+inline fe25519 fe25519::sqr(const int n) const {
+    fe25519 r = *this;
+    for (int i = 0; i < n; ++i)
+        r = r.sqr();
+    return r;
+}
+
+inline void fe25519::pow2250(fe25519 &t250, fe25519 &t11) const {
+    const fe25519 t2 = sqr();
+    const fe25519 t9 = t2.sqr(2) * *this;
+    t11 = t9 * t2;
+    const fe25519 t5 = t11.sqr() * t9; // 2^5 - 1
+    const fe25519 t10 = t5.sqr(5) * t5; // 2^10 - 1
+    const fe25519 t20 = t10.sqr(10) * t10;
+    const fe25519 t40 = t20.sqr(20) * t20;
+    const fe25519 t50 = t40.sqr(10) * t10;
+    const fe25519 t100 = t50.sqr(50) * t50;
+    const fe25519 t200 = t100.sqr(100) * t100;
+    t250 = t200.sqr(50) * t50;
+}
+
+inline fe25519 fe25519::inv() const {
+    fe25519 t250, t11;
+    pow2250(t250, t11);
+    return t250.sqr(5) * t11; // 2^255 - 32 + 11 = p - 2
+}
+
+inline fe25519 fe25519::pow22523() const {
+    fe25519 t250, t11;
+    pow2250(t250, t11);
+    return t250.sqr(2) * *this; // 2^252 - 4 + 1
+}
+
+inline void fe25519::cswap(fe25519 &a, fe25519 &b, const uint64_t bit) {
+    const uint64_t m = -bit;
+    for (int i = 0; i < 5; ++i) {
+        const uint64_t x = (a.v[i] ^ b.v[i]) & m;
+        a.v[i] ^= x;
+        b.v[i] ^= x;
+    }
+}
+
+
+#endif
@@ -0,0 +1,343 @@
+//
+// Created by wtchr on 10/19/2026.
+//
+
+#ifndef FE256_H
+#define FE256_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <gmpxx.h>
+
+static_assert(GMP_NUMB_BITS == 64, "fe256 requires 64-bit limbs");
+
+
+// Fixed-length limb primitives. Calling mpn functions for four limbs costs more than the arithmetic itself, so these
+// are inlined, and the limb loops are unrolled so that the carries stay in registers. Each runs the same instructions
+// whatever the values.
+namespace fe256_detail {
+    using u128 = unsigned __int128;
+
+    // r = a + b, returns the carry.
+    inline mp_limb_t add4(mp_limb_t *r, const mp_limb_t *a, const mp_limb_t *b) {
+        u128 acc = 0;
+        #pragma GCC unroll 4
+        for (int i = 0; i < 4; ++i) {
+            acc += static_cast<u128>(a[i]) + b[i];
+            r[i] = static_cast<mp_limb_t>(acc);
+            acc >>= 64;
+        }
+        return static_cast<mp_limb_t>(acc);
+    }
+
+    // r = a - b, returns the borrow.
+    inline mp_limb_t sub4(mp_limb_t *r, const mp_limb_t *a, const mp_limb_t *b) {
+        mp_limb_t borrow = 0;
+        #pragma GCC unroll 4
+        for (int i = 0; i < 4; ++i) {
+            const u128 d = static_cast<u128>(a[i]) - b[i] - borrow;
+            r[i] = static_cast<mp_limb_t>(d);
+            borrow = static_cast<mp_limb_t>(d >> 64) & 1;
+        }
+        return borrow;
+    }
+
+    // r = cnd ? a : r for cnd in {0, 1}.
+    inline void select4(mp_limb_t *r, const mp_limb_t *a, const mp_limb_t cnd) {
+        const mp_limb_t mask = -cnd;
+        #pragma GCC unroll 4
+        for (int i = 0; i < 4; ++i)
+            r[i] ^= (r[i] ^ a[i]) & mask;
+    }
+
+    // t = a * b (8 limbs).
+    inline void mul4(mp_limb_t *t, const mp_limb_t *a, const mp_limb_t *b) {
+        #pragma GCC unroll 4
+        for (int i = 0; i < 4; ++i) {
+            u128 acc = 0;
+            #pragma GCC unroll 4
+            for (int j = 0; j < 4; ++j) {
+                acc += static_cast<u128>(a[i]) * b[j] + (i ? t[i + j] : 0);
+                t[i + j] = static_cast<mp_limb_t>(acc);
+                acc >>= 64;
+            }
+            t[i + 4] = static_cast<mp_limb_t>(acc);
+        }
+    }
+}
+
+
+/**
+ * @brief Field parameters of NIST P-256, p = 2^256 - 2^224 + 2^192 + 2^96 - 1.
+ *
+ * Elements are kept in Montgomery form with R = 2^256. Since p = -1 mod 2^64, the Montgomery constant -p^-1 mod 2^64
+ * is 1 and every reduction step multiplies by p's limbs directly.
+ */
+struct p256_field {
+    static constexpr std::array<mp_limb_t, 4> p = {
+            0xffffffffffffffff, 0x00000000ffffffff, 0x0000000000000000, 0xffffffff00000001
+    };
+    static constexpr std::array<mp_limb_t, 4> r2 = {
+            0x0000000000000003, 0xfffffffbffffffff, 0xfffffffffffffffe, 0x00000004fffffffd
+    }; ///< R^2 mod p
+    static constexpr bool montgomery = true;
+    static constexpr bool a_is_minus_3 = true; ///< Curve coefficient a = -3
+
+    /**
+     * @brief Montgomery reduction: r = t * 2^-256 mod p.
+     * @param[out] r The result (4 limbs, fully reduced).
+     * @param[in,out] t The input (8 limbs, less than 2^256 * p), destroyed.
+     */
+    static void reduce(mp_limb_t *r, mp_limb_t *t);
+};
+
+
+/**
+ * @brief Field parameters of secp256k1, p = 2^256 - 2^32 - 977.
+ *
+ * Elements are kept in normal form; a product is reduced by folding its upper half with 2^256 = 2^32 + 977 mod p.
+ */
+struct secp256k1_field {
+    static constexpr std::array<mp_limb_t, 4> p = {
+            0xfffffffefffffc2f, 0xffffffffffffffff, 0xffffffffffffffff, 0xffffffffffffffff
+    };
+    static constexpr mp_limb_t c = 0x1000003d1; ///< 2^256 - p
+    static constexpr bool montgomery = false;
+    static constexpr bool a_is_minus_3 = false; ///< Curve coefficient a = 0
+
+    /**
+     * @brief Reduction: r = t mod p.
+     * @param[out] r The result (4 limbs, fully reduced).
+     * @param[in,out] t The input (8 limbs), destroyed.
+     */
+    static void reduce(mp_limb_t *r, mp_limb_t *t);
+};
+
+
+/**
+ * @brief Element of a 256-bit prime field in four 64-bit limbs.
+ *
+ * The element lives on the stack and every operation runs a fixed sequence of word operations, so field and point
+ * arithmetic built on it neither allocates nor branches on the values.
+ *
+ * @tparam Field The field parameters (p256_field or secp256k1_field).
+ */
+template<class Field>
+struct fe256 {
+    std::array<mp_limb_t, 4> v{}; ///< Limbs, least significant first, in the representation of Field
+
+    /**
+     * @brief Converts from normal form.
+     * @param a The value in [0, p) as 4 limbs.
+     */
+    static fe256 from_limbs(const mp_limb_t *a);
+
+    /**
+     * @brief Converts from an mpz_class number in [0, p).
+     */
+    static fe256 from_mpz(const mpz_class &a);
+
+    /**
+     * @brief Returns the element 1.
+     */
+    static fe256 one();
+
+    /**
+     * @brief Converts to normal form.
+     * @param[out] r The value in [0, p) as 4 limbs.
+     */
+    void to_limbs(mp_limb_t *r) const;
+
+    /**
+     * @brief Converts to an mpz_class number in [0, p).
+     */
+    [[nodiscard]]
+    mpz_class to_mpz() const;
+
+    [[nodiscard]]
+    bool is_zero() const;
+
+    bool operator==(const fe256 &r) const = default;
+
+    fe256 operator+(const fe256 &r) const;
+    fe256 operator-(const fe256 &r) const;
+    fe256 operator*(const fe256 &r) const;
+
+    /**
+     * @brief Returns the square of the element.
+     */
+    [[nodiscard]]
+    fe256 sqr() const;
+
+    /**
+     * @brief Returns the inverse by Fermat's little theorem (a^(p - 2)); the inverse of 0 is 0.
+     */
+    [[nodiscard]]
+    fe256 inv() const;
+};
+
+
+inline void p256_field::reduce(mp_limb_t *r, mp_limb_t *t) {
+    mp_limb_t top = 0; // Carry beyond t[7]
+    #pragma GCC unroll 4
+    for (int i = 0; i < 4; ++i) {
+        // Adding t[i] * p clears limb i (the Montgomery factor is t[i] itself).
+        const mp_limb_t m = t[i];
+        unsigned __int128 acc = 0;
+        #pragma GCC unroll 4
+        for (int j = 0; j < 4; ++j) {
+            acc += static_cast<unsigned __int128>(m) * p[j] + t[i + j];
+            t[i + j] = static_cast<mp_limb_t>(acc);
+            acc >>= 64;
+        }
+        #pragma GCC unroll 4
+        for (int j = i + 4; j < 8; ++j) {
+            acc += t[j];
+            t[j] = static_cast<mp_limb_t>(acc);
+            acc >>= 64;
+        }
+        top += static_cast<mp_limb_t>(acc);
+    }
+    // t[4..7] + top * 2^256 < 2p: subtract p once unless that borrows.
+    const mp_limb_t borrow = fe256_detail::sub4(r, t + 4, p.data());
+    fe256_detail::select4(r, t + 4, borrow & (top ^ 1));
+}
+
+inline void secp256k1_field::reduce(mp_limb_t *r, mp_limb_t *t) {
+    // t = lo + hi * 2^256 = lo + hi * c (mod p), folded twice to get below 2^256 + small.
+    unsigned __int128 acc = 0;
+    #pragma GCC unroll 4
+    for (int i = 0; i < 4; ++i) {
+        acc += static_cast<unsigned __int128>(t[4 + i]) * c + t[i];
+        t[i] = static_cast<mp_limb_t>(acc);
+        acc >>= 64;
+    }
+    acc = static_cast<unsigned __int128>(static_cast<mp_limb_t>(acc)) * c + t[0];
+    t[0] = static_cast<mp_limb_t>(acc);
+    acc >>= 64;
+    #pragma GCC unroll 4
+    for (int i = 1; i < 4; ++i) {
+        acc += t[i];
+        t[i] = static_cast<mp_limb_t>(acc);
+        acc >>= 64;
+    }
+    // A final carry means the value wrapped past 2^256; the low part is then tiny, so adding c cannot carry again.
+    const mp_limb_t carry = static_cast<mp_limb_t>(acc);
+    const mp_limb_t add[4] = {carry * c, 0, 0, 0};
+    fe256_detail::add4(t, t, add);
+    const mp_limb_t borrow = fe256_detail::sub4(r, t, p.data());
+    fe256_detail::select4(r, t, borrow);
+}
+
+
+template<class Field>
+fe256<Field> fe256<Field>::from_limbs(const mp_limb_t *a) {
+    fe256 r;
+    if constexpr (Field::montgomery) {
+        mp_limb_t t[8];
+        fe256_detail::mul4(t, a, Field::r2.data());
+        Field::reduce(r.v.data(), t);
+    } else {
+        std::copy_n(a, 4, r.v.data());
+    }
+    return r;
+}
+
+template<class Field>
+fe256<Field> fe256<Field>::from_mpz(const mpz_class &a) {
+    mp_limb_t t[4];
+    for (int i = 0; i < 4; ++i)
+        t[i] = mpz_getlimbn(a.get_mpz_t(), i);
+    return from_limbs(t);
+}
+
+template<class Field>
+fe256<Field> fe256<Field>::one() {
+    constexpr mp_limb_t t[4] = {1, 0, 0, 0};
+    return from_limbs(t);
+}
+
+template<class Field>
+void fe256<Field>::to_limbs(mp_limb_t *r) const {
+    if constexpr (Field::montgomery) {
+        mp_limb_t t[8] = {v[0], v[1], v[2], v[3], 0, 0, 0, 0};
+        Field::reduce(r, t);
+    } else {
+        std::copy_n(v.data(), 4, r);
+    }
+}
+
+template<class Field>
+mpz_class fe256<Field>::to_mpz() const {
+    mpz_class r;
+    to_limbs(mpz_limbs_write(r.get_mpz_t(), 4));
+    mpz_limbs_finish(r.get_mpz_t(), 4);
+    return r;
+}
+
+template<class Field>
+bool fe256<Field>::is_zero() const {
+    return (v[0] | v[1] | v[2] | v[3]) == 0;
+}
+
+template<class Field>
+fe256<Field> fe256<Field>::operator+(const fe256 &r) const {
+    fe256 s, t;
+    const mp_limb_t carry = fe256_detail::add4(s.v.data(), v.data(), r.v.data());
+    const mp_limb_t borrow = fe256_detail::sub4(t.v.data(), s.v.data(), Field::p.data());
+    // Keep s - p unless s < p (borrow without carry).
+    fe256_detail::select4(s.v.data(), t.v.data(), carry | (borrow ^ 1));
+    return s;
+}
+
+template<class Field>
+fe256<Field> fe256<Field>::operator-(const fe256 &r) const {
+    fe256 s;
+    const mp_limb_t borrow = fe256_detail::sub4(s.v.data(), v.data(), r.v.data());
+    mp_limb_t p[4];
+    for (int i = 0; i < 4; ++i)
+        p[i] = Field::p[i] & -borrow;
+    fe256_detail::add4(s.v.data(), s.v.data(), p);
+    return s;
+}
+
+template<class Field>
+fe256<Field> fe256<Field>::operator*(const fe256 &r) const {
+    fe256 s;
+    mp_limb_t t[8];
+    fe256_detail::mul4(t, v.data(), r.v.data());
+    Field::reduce(s.v.data(), t);
+    return s;
+}
+
+template<class Field>
+fe256<Field> fe256<Field>::sqr() const {
+    fe256 s;
+    mp_limb_t t[8];
+    fe256_detail::mul4(t, v.data(), v.data());
+    Field::reduce(s.v.data(), t);
+    return s;
+}
+
+template<class Field>
+fe256<Field> fe256<Field>::inv() const {
+    // p - 2 differs from p only in the lowest limb (p is odd and its lowest limb exceeds 1). The exponent is public,
+    // so it is processed in 4-bit windows with a table of the powers a^0, ..., a^15.
+    std::array<mp_limb_t, 4> e = Field::p;
+    e[0] -= 2;
+    std::array<fe256, 16> pow;
+    pow[0] = one();
+    for (size_t i = 1; i < pow.size(); ++i)
+        pow[i] = pow[i - 1] * *this;
+    fe256 r = one();
+    for (int i = 63; i >= 0; --i) {
+        r = r.sqr().sqr().sqr().sqr();
+        if (const mp_limb_t d = e[i / 16] >> (i % 16 * 4) & 15)
+            r = r * pow[d];
+    }
+    return r;
+}
+
+
+#endif
@@ -7,7 +7,8 @@
 
 #include <algorithm>
 #include <array>
-#include <vector>
+#include <concepts>
+#include <cstddef>
 
 
 /**
@@ -21,6 +22,8 @@ template<typename Hash>
 concept HashFunction = requires(Hash h, const unsigned char *begin, const unsigned char *end) {
     { Hash::block_size } -> std::convertible_to<size_t>;
     { h.hash(begin, end) } -> std::convertible_to<std::array<unsigned char, Hash::output_size>>;
+    { h.update(begin, end) };
+    { h.digest() } -> std::convertible_to<std::array<unsigned char, Hash::output_size>>;
 };
 
 
@@ -28,6 +31,7 @@ concept HashFunction = requires(Hash h, const unsigned char *begin, const unsign
  * @brief HMAC (Hash-based Message Authentication Code) class template.
  *
  * This class provides functionalities for computing HMAC using a specified hash function.
+ * The key pads are absorbed once when the key is set; each MAC then starts from copies of those hash states.
  *
  * @tparam Hash The hash function to be used (e.g., sha256).
  */
@@ -56,12 +60,32 @@ public:
      * @return The HMAC as an array of bytes.
      */
     template<typename It>
-    auto hash(It begin, It end);
+    auto hash(It begin, It end) const;
+
+    /**
+     * @brief Starts a new incremental MAC computation with the current key.
+     */
+    void init();
+
+    /**
+     * @brief Absorbs more input data into the running MAC.
+     * @tparam It Iterator type for the input data.
+     * @param begin Iterator pointing to the beginning of the input data.
+     * @param end Iterator pointing to the end of the input data.
+     */
+    template<typename It>
+    void update(It begin, It end);
+
+    /**
+     * @brief Finishes the running MAC and starts a new one with the same key.
+     * @return The HMAC of all data absorbed since the last init() or digest().
+     */
+    std::array<unsigned char, Hash::output_size> digest();
 
 protected:
-    Hash hash_; ///< Hash function instance.
-    std::array<unsigned char, Hash::block_size> o_key_pad; ///< Key XORed outer pad.
-    std::array<unsigned char, Hash::block_size> i_key_pad; ///< Key XORed inner pad.
+    Hash i_hash; ///< Hash state after absorbing the key XORed inner pad.
+    Hash o_hash; ///< Hash state after absorbing the key XORed outer pad.
+    Hash ctx; ///< Running inner hash of an incremental MAC computation.
 };
 
 template<HashFunction Hash>
@@ -69,8 +93,8 @@ template<typename It>
 void hmac<Hash>::key(const It begin, const It end) {
     std::array<unsigned char, Hash::block_size> key{}; // Zero-padded key
     // Hash the key if it is longer than the block size
-    if (end - begin > Hash::block_size) {
-        auto h = hash_.hash(begin, end);
+    if (end - begin > static_cast<std::ptrdiff_t>(Hash::block_size)) {
+        auto h = i_hash.hash(begin, end);
         std::copy(h.begin(), h.end(), key.begin());
     } else {
         std::copy(begin, end, key.begin());
@@ -78,24 +102,50 @@ void hmac<Hash>::key(const It begin, const It end) {
     // XOR the key with the inner and outer pads:
     // inner pad = the byte 0x36 repeated Hash::block_size times,
     // outer pad = the byte 0x5c repeated Hash::block_size times.
+    std::array<unsigned char, Hash::block_size> i_key_pad, o_key_pad;
     for (size_t i = 0; i < Hash::block_size; ++i) {
         i_key_pad[i] = key[i] ^ 0x36;
         o_key_pad[i] = key[i] ^ 0x5c;
     }
+    // Both pads are exactly one block, so this leaves the compressed midstates behind.
+    i_hash.init();
+    i_hash.update(i_key_pad.begin(), i_key_pad.end());
+    o_hash.init();
+    o_hash.update(o_key_pad.begin(), o_key_pad.end());
+    ctx = i_hash;
 }
 
 template<HashFunction Hash>
 template<typename It>
-auto hmac<Hash>::hash(It begin, It end) {
-    // Append the message to the inner key pad and hash it
-    std::vector<unsigned char> v{i_key_pad.begin(), i_key_pad.end()};
-    v.insert(v.end(), begin, end);
-    auto h = hash_.hash(v.begin(), v.end());
-    // Append the previous hash result to the outer key pad and hash it
-    v.clear();
-    v.insert(v.end(), o_key_pad.begin(), o_key_pad.end());
-    v.insert(v.end(), h.begin(), h.end());
-    return hash_.hash(v.begin(), v.end());
+auto hmac<Hash>::hash(It begin, It end) const {
+    // Continue the inner hash with the message
+    Hash h = i_hash;
+    h.update(begin, end);
+    const auto inner = h.digest();
+    // Continue the outer hash with the inner result
+    h = o_hash;
+    h.update(inner.begin(), inner.end());
+    return h.digest();
+}
+
+template<HashFunction Hash>
+void hmac<Hash>::init() {
+    ctx = i_hash;
+}
+
+template<HashFunction Hash>
+template<typename It>
+void hmac<Hash>::update(It begin, It end) {
+    ctx.update(begin, end);
+}
+
+template<HashFunction Hash>
+std::array<unsigned char, Hash::output_size> hmac<Hash>::digest() {
+    const auto inner = ctx.digest();
+    Hash h = o_hash;
+    h.update(inner.begin(), inner.end());
+    ctx = i_hash;
+    return h.digest();
 }
 
 
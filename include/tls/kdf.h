@@ -0,0 +1,175 @@
+//
+// Created by wtchr on 10/19/2026.
+//
+
+#ifndef KDF_H
+#define KDF_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include "tls/hmac.h"
+
+
+/**
+ * @brief TLS 1.2 pseudorandom function (RFC 5246, section 5).
+ *
+ * Computes P_hash(secret, label + seed). The secret is keyed into the HMAC once; every expansion step continues
+ * from the cached HMAC midstates and output blocks are written straight into the caller's buffer.
+ *
+ * @tparam Hash The hash function to be used (e.g., sha256).
+ */
+template<HashFunction Hash>
+class prf {
+public:
+    /**
+     * @brief Sets the secret.
+     * @tparam It Iterator type for the secret.
+     * @param begin Iterator pointing to the beginning of the secret.
+     * @param end Iterator pointing to the end of the secret.
+     */
+    template<typename It>
+    void secret(It begin, It end);
+
+    /**
+     * @brief Fills the output range with P_hash(secret, label + seed).
+     * @tparam L Iterator type for the label.
+     * @tparam S Iterator type for the seed.
+     * @tparam Out Output iterator type.
+     * @param label_begin Iterator pointing to the beginning of the label.
+     * @param label_end Iterator pointing to the end of the label.
+     * @param seed_begin Iterator pointing to the beginning of the seed.
+     * @param seed_end Iterator pointing to the end of the seed.
+     * @param[out] out_begin Iterator pointing to the beginning of the output.
+     * @param[out] out_end Iterator pointing to the end of the output.
+     */
+    template<typename L, typename S, typename Out>
+    void expand(L label_begin, L label_end, S seed_begin, S seed_end, Out out_begin, Out out_end) const;
+
+protected:
+    hmac<Hash> mac; ///< HMAC keyed with the secret.
+};
+
+template<HashFunction Hash>
+template<typename It>
+void prf<Hash>::secret(It begin, It end) {
+    mac.key(begin, end);
+}
+
+template<HashFunction Hash>
+template<typename L, typename S, typename Out>
+void prf<Hash>::expand(L label_begin, L label_end, S seed_begin, S seed_end, Out out_begin, Out out_end) const {
+    // A(0) = label + seed, A(i) = HMAC(secret, A(i - 1))
+    // P_hash = HMAC(secret, A(1) + label + seed) + HMAC(secret, A(2) + label + seed) + ...
+    hmac<Hash> h = mac;
+    h.update(label_begin, label_end);
+    h.update(seed_begin, seed_end);
+    auto a = h.digest();
+    while (out_begin != out_end) {
+        h.update(a.begin(), a.end());
+        h.update(label_begin, label_end);
+        h.update(seed_begin, seed_end);
+        const auto block = h.digest();
+        for (auto it = block.begin(); it != block.end() && out_begin != out_end; ++it, ++out_begin)
+            *out_begin = *it;
+        if (out_begin == out_end)
+            break;
+        h.update(a.begin(), a.end());
+        a = h.digest();
+    }
+}
+
+
+/**
+ * @brief HMAC-based key derivation function (RFC 5869).
+ *
+ * The pseudorandom key (PRK) is kept as a keyed HMAC, so each expansion only continues from its midstates.
+ *
+ * @tparam Hash The hash function to be used (e.g., sha256).
+ */
+template<HashFunction Hash>
+class hkdf {
+public:
+    /**
+     * @brief HKDF-Extract: derives the pseudorandom key from the input keying material and keeps it.
+     * @tparam S Iterator type for the salt.
+     * @tparam It Iterator type for the input keying material.
+     * @param salt_begin Iterator pointing to the beginning of the salt (an empty salt means HashLen zero bytes).
+     * @param salt_end Iterator pointing to the end of the salt.
+     * @param ikm_begin Iterator pointing to the beginning of the input keying material.
+     * @param ikm_end Iterator pointing to the end of the input keying material.
+     * @return The pseudorandom key.
+     */
+    template<typename S, typename It>
+    std::array<unsigned char, Hash::output_size> extract(S salt_begin, S salt_end, It ikm_begin, It ikm_end);
+
+    /**
+     * @brief Sets an already extracted pseudorandom key.
+     * @tparam It Iterator type for the key.
+     * @param begin Iterator pointing to the beginning of the key.
+     * @param end Iterator pointing to the end of the key.
+     */
+    template<typename It>
+    void key(It begin, It end);
+
+    /**
+     * @brief HKDF-Expand: fills the output range with output keying material.
+     * @tparam It Iterator type for the info.
+     * @tparam Out Output iterator type.
+     * @param info_begin Iterator pointing to the beginning of the context and application specific information.
+     * @param info_end Iterator pointing to the end of the info.
+     * @param[out] out_begin Iterator pointing to the beginning of the output (at most 255 * HashLen bytes).
+     * @param[out] out_end Iterator pointing to the end of the output.
+     * @throws std::invalid_argument If the output is longer than 255 * HashLen bytes.
+     */
+    template<typename It, typename Out>
+    void expand(It info_begin, It info_end, Out out_begin, Out out_end) const;
+
+protected:
+    hmac<Hash> mac; ///< HMAC keyed with the pseudorandom key.
+};
+
+template<HashFunction Hash>
+template<typename S, typename It>
+std::array<unsigned char, Hash::output_size>
+hkdf<Hash>::extract(S salt_begin, S salt_end, It ikm_begin, It ikm_end) {
+    if (salt_begin == salt_end) {
+        constexpr std::array<unsigned char, Hash::output_size> zeros{};
+        mac.key(zeros.begin(), zeros.end());
+    } else {
+        mac.key(salt_begin, salt_end);
+    }
+    const auto prk = mac.hash(ikm_begin, ikm_end);
+    mac.key(prk.begin(), prk.end());
+    return prk;
+}
+
+template<HashFunction Hash>
+template<typename It>
+void hkdf<Hash>::key(It begin, It end) {
+    mac.key(begin, end);
+}
+
+template<HashFunction Hash>
+template<typename It, typename Out>
+void hkdf<Hash>::expand(It info_begin, It info_end, Out out_begin, Out out_end) const {
+    // T(0) = empty, T(i) = HMAC(PRK, T(i - 1) + info + i), OKM = T(1) + T(2) + ...
+    if (std::distance(out_begin, out_end) > static_cast<std::ptrdiff_t>(255 * Hash::output_size))
+        throw std::invalid_argument("HKDF output is limited to 255 * HashLen bytes");
+    hmac<Hash> h = mac;
+    std::array<unsigned char, Hash::output_size> t{};
+    for (unsigned char i = 1; out_begin != out_end; ++i) {
+        if (i > 1)
+            h.update(t.begin(), t.end());
+        h.update(info_begin, info_end);
+        h.update(&i, &i + 1);
+        t = h.digest();
+        for (auto it = t.begin(); it != t.end() && out_begin != out_end; ++it, ++out_begin)
+            *out_begin = *it;
+    }
+}
+
+
+#endif
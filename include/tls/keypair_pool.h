@@ -0,0 +1,219 @@
+//
+// Created by wtchr on 10/19/2026.
+//
+
+#ifndef KEYPAIR_POOL_H
+#define KEYPAIR_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "tls/mpmc_queue.h"
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+
+/**
+ * @brief Pool of ephemeral keypairs generated ahead of time on background threads.
+ *
+ * Background threads run at the lowest scheduling priority and keep the number of ready keypairs between the low
+ * and the high watermark: they stop generating when the high watermark is reached and resume once consumers drain
+ * the pool below the low watermark. take() pops from a lock-free queue and never waits for a producer; if the pool
+ * is empty it generates the keypair inline instead. Producers may also generate in batches, so that the keypairs of
+ * a batch can share work such as a modular inversion.
+ *
+ * @tparam Keypair The keypair type (e.g., diffie_hellman, ec_keypair).
+ */
+template<typename Keypair>
+class keypair_pool {
+public:
+    /**
+     * @brief Usage statistics of the pool.
+     */
+    struct statistics {
+        uint64_t generated; ///< Keypairs generated by the background threads.
+        uint64_t hits; ///< take() calls served from the pool.
+        uint64_t misses; ///< take() calls that had to generate inline.
+        size_t available; ///< Keypairs currently ready.
+    };
+
+    /**
+     * @brief Constructs the pool and starts the background threads.
+     * @param generate Function creating one keypair; it is called concurrently from several threads.
+     * @param low_watermark Producers resume when fewer keypairs than this are ready.
+     * @param high_watermark Producers pause when this many keypairs are ready.
+     * @param threads The number of background threads.
+     */
+    keypair_pool(std::function<Keypair()> generate, size_t low_watermark, size_t high_watermark, unsigned threads = 1);
+
+    /**
+     * @brief Constructs the pool with a batch generator for the background threads.
+     * @param generate Function creating one keypair, used by take() when the pool is empty.
+     * @param generate_batch Function creating several keypairs at once; it is called concurrently from the
+     * background threads, and keypairs that no longer fit into the pool are discarded.
+     * @param low_watermark Producers resume when fewer keypairs than this are ready.
+     * @param high_watermark Producers pause when this many keypairs are ready.
+     * @param threads The number of background threads.
+     */
+    keypair_pool(std::function<Keypair()> generate, std::function<std::vector<Keypair>()> generate_batch,
+                 size_t low_watermark, size_t high_watermark, unsigned threads = 1);
+
+    keypair_pool(const keypair_pool &) = delete;
+    keypair_pool &operator=(const keypair_pool &) = delete;
+
+    /**
+     * @brief Stops and joins the background threads.
+     */
+    ~keypair_pool();
+
+    /**
+     * @brief Takes a ready keypair, or generates one inline if the pool is empty.
+     * @return A fresh keypair that is handed out only once.
+     */
+    Keypair take();
+
+    /**
+     * @brief Returns a snapshot of the usage statistics.
+     */
+    [[nodiscard]]
+    statistics stats() const;
+
+private:
+    std::function<Keypair()> generate;
+    std::function<std::vector<Keypair>()> generate_batch; ///< Empty if producers generate one at a time.
+    const size_t low_watermark, high_watermark;
+    mpmc_queue<Keypair> queue;
+    std::atomic<size_t> reserved{0}; ///< Queue slots claimed by producers, bounded by high_watermark.
+    std::atomic<std::ptrdiff_t> available{0}; ///< Keypairs pushed and not yet popped; may lag behind the queue.
+    std::atomic<uint64_t> generated{0}, hits{0}, misses{0};
+    std::atomic<uint32_t> wake{0}; ///< Bumped to wake sleeping producers.
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> producers;
+
+    /**
+     * @brief Background thread body.
+     */
+    void produce();
+
+    /**
+     * @brief Makes a generated keypair available.
+     * @return False if the pool was full and the keypair was discarded.
+     */
+    bool publish(Keypair &&k);
+};
+
+template<typename Keypair>
+keypair_pool<Keypair>::keypair_pool(
+        std::function<Keypair()> generate, const size_t low_watermark, const size_t high_watermark,
+        const unsigned threads
+)
+    : keypair_pool{std::move(generate), nullptr, low_watermark, high_watermark, threads} {}
+
+template<typename Keypair>
+keypair_pool<Keypair>::keypair_pool(
+        std::function<Keypair()> generate, std::function<std::vector<Keypair>()> generate_batch,
+        const size_t low_watermark, const size_t high_watermark, const unsigned threads
+)
+    : generate{std::move(generate)}
+    , generate_batch{std::move(generate_batch)}
+    , low_watermark{low_watermark}
+    , high_watermark{high_watermark}
+    , queue{high_watermark} {
+    assert(low_watermark <= high_watermark && high_watermark > 0);
+    for (unsigned i = 0; i < threads; ++i)
+        producers.emplace_back(&keypair_pool::produce, this);
+}
+
+template<typename Keypair>
+keypair_pool<Keypair>::~keypair_pool() {
+    stop.store(true);
+    wake.fetch_add(1);
+    wake.notify_all();
+    for (auto &t : producers)
+        t.join();
+}
+
+template<typename Keypair>
+Keypair keypair_pool<Keypair>::take() {
+    if (auto k = queue.try_pop()) {
+        hits.fetch_add(1, std::memory_order_relaxed);
+        // The producer may not have counted this keypair yet, so available can dip below zero briefly.
+        available.fetch_sub(1, std::memory_order_relaxed);
+        // Wake the producers once the pool is at or below the low watermark.
+        if (reserved.fetch_sub(1, std::memory_order_acq_rel) <= low_watermark) {
+            wake.fetch_add(1, std::memory_order_release);
+            wake.notify_all();
+        }
+        return std::move(*k);
+    }
+    misses.fetch_add(1, std::memory_order_relaxed);
+    wake.fetch_add(1, std::memory_order_release);
+    wake.notify_all();
+    return generate();
+}
+
+template<typename Keypair>
+typename keypair_pool<Keypair>::statistics keypair_pool<Keypair>::stats() const {
+    return {
+            generated.load(std::memory_order_relaxed), hits.load(std::memory_order_relaxed),
+            misses.load(std::memory_order_relaxed),
+            static_cast<size_t>(std::max<std::ptrdiff_t>(available.load(std::memory_order_acquire), 0))
+    };
+}
+
+template<typename Keypair>
+void keypair_pool<Keypair>::produce() {
+#if defined(__linux__)
+    // Linux applies nice values per thread.
+    setpriority(PRIO_PROCESS, static_cast<id_t>(gettid()), 19);
+#endif
+    while (!stop.load(std::memory_order_relaxed)) {
+        if (reserved.load(std::memory_order_acquire) >= high_watermark) {
+            // Full: sleep until a consumer crosses the low watermark.
+            const uint32_t w = wake.load(std::memory_order_acquire);
+            while (!stop.load(std::memory_order_relaxed) &&
+                   reserved.load(std::memory_order_acquire) >= low_watermark) {
+                wake.wait(w, std::memory_order_acquire);
+                if (wake.load(std::memory_order_acquire) != w)
+                    break;
+            }
+            continue;
+        }
+        if (generate_batch) {
+            for (Keypair &k : generate_batch())
+                if (!publish(std::move(k)))
+                    break;
+        } else {
+            publish(generate());
+        }
+    }
+}
+
+template<typename Keypair>
+bool keypair_pool<Keypair>::publish(Keypair &&k) {
+    // Reserve a slot first: the queue capacity is rounded up to a power of two, so it does not bound the pool.
+    size_t r = reserved.load(std::memory_order_relaxed);
+    do {
+        if (r >= high_watermark)
+            return false;
+    } while (!reserved.compare_exchange_weak(r, r + 1, std::memory_order_acq_rel, std::memory_order_relaxed));
+    // At most high_watermark slots are reserved, so the push cannot fail.
+    [[maybe_unused]] const bool pushed = queue.try_push(std::move(k));
+    assert(pushed);
+    // Count the keypair only once it can be popped.
+    available.fetch_add(1, std::memory_order_release);
+    generated.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+
+#endif
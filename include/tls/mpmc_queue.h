@@ -0,0 +1,124 @@
+//
+// Created by wtchr on 10/19/2026.
+//
+
+#ifndef MPMC_QUEUE_H
+#define MPMC_QUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+
+/**
+ * @brief Bounded lock-free multi-producer multi-consumer queue.
+ *
+ * Each cell carries a sequence number that tells producers and consumers whether it is free or filled for the
+ * current lap (D. Vyukov's bounded MPMC queue). Neither push nor pop ever blocks; they fail instead when the queue
+ * is full or empty.
+ *
+ * @tparam T The element type.
+ */
+template<typename T>
+class mpmc_queue {
+public:
+    /**
+     * @brief Constructs an empty queue.
+     * @param capacity The minimum capacity; it is rounded up to a power of two.
+     */
+    explicit mpmc_queue(size_t capacity);
+
+    mpmc_queue(const mpmc_queue &) = delete;
+    mpmc_queue &operator=(const mpmc_queue &) = delete;
+
+    /**
+     * @brief Appends an element unless the queue is full.
+     * @param v The element to append.
+     * @return True if the element was appended.
+     */
+    bool try_push(T &&v);
+
+    /**
+     * @brief Removes the oldest element unless the queue is empty.
+     * @return The element, or std::nullopt if the queue was empty.
+     */
+    std::optional<T> try_pop();
+
+    /**
+     * @brief Returns the capacity of the queue.
+     */
+    [[nodiscard]]
+    size_t capacity() const {
+        return mask + 1;
+    }
+
+private:
+    struct cell {
+        std::atomic<size_t> seq;
+        std::optional<T> value;
+    };
+
+    std::unique_ptr<cell[]> cells;
+    const size_t mask;
+    alignas(64) std::atomic<size_t> enqueue_pos{0};
+    alignas(64) std::atomic<size_t> dequeue_pos{0};
+};
+
+template<typename T>
+mpmc_queue<T>::mpmc_queue(const size_t capacity)
+    : cells{new cell[std::bit_ceil(std::max<size_t>(capacity, 2))]}
+    , mask{std::bit_ceil(std::max<size_t>(capacity, 2)) - 1} {
+    for (size_t i = 0; i <= mask; ++i)
+        cells[i].seq.store(i, std::memory_order_relaxed);
+}
+
+template<typename T>
+bool mpmc_queue<T>::try_push(T &&v) {
+    size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+        cell &c = cells[pos & mask];
+        const size_t seq = c.seq.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+        if (diff == 0) {
+            // The cell is free for this lap; claim it.
+            if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                c.value.emplace(std::move(v));
+                c.seq.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false; // Full
+        } else {
+            pos = enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template<typename T>
+std::optional<T> mpmc_queue<T>::try_pop() {
+    size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+        cell &c = cells[pos & mask];
+        const size_t seq = c.seq.load(std::memory_order_acquire);
+        const auto diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+        if (diff == 0) {
+            // The cell holds an element of this lap; claim it.
+            if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                std::optional<T> r{std::move(*c.value)};
+                c.value.reset();
+                c.seq.store(pos + mask + 1, std::memory_order_release);
+                return r;
+            }
+        } else if (diff < 0) {
+            return std::nullopt; // Empty
+        } else {
+            pos = dequeue_pos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+
+#endif
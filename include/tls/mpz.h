@@ -5,9 +5,17 @@
 #ifndef MPZ_H
 #define MPZ_H
 
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
 #include <gmpxx.h>
 #include <iomanip>
+#include <iterator>
+#include <memory>
+#include <span>
 #include <sstream>
+#include <type_traits>
+#include <vector>
 
 
 /**
@@ -28,6 +36,97 @@ mpz_class nextprime(const mpz_class &n);
 [[nodiscard]]
 mpz_class powm(const mpz_class &base, const mpz_class &exp, const mpz_class &mod);
 
+/**
+ * @brief Precomputed powers of a fixed base for fast modular exponentiation.
+ *
+ * Stores g^(2^(w * i)) mod m for every w-bit window of the exponent and evaluates g^e with Yao's method
+ * (also known as BGMW): about bits / w + 2^(w + 1) modular multiplications and no squarings, compared to one
+ * squaring per exponent bit for a general exponentiation. The table is immutable once built, so one instance can be
+ * shared by any number of threads.
+ */
+class fixed_base_powm {
+public:
+    /**
+     * @brief Builds the table.
+     * @param base The fixed base g.
+     * @param mod The modulus m.
+     * @param max_exp_bits The largest exponent size the table covers; larger exponents fall back to powm().
+     * @param window The window size w in bits (must divide the limb size).
+     */
+    fixed_base_powm(const mpz_class &base, const mpz_class &mod, size_t max_exp_bits, unsigned window = 4);
+
+    /**
+     * @brief Computes (base^exp) % mod.
+     * @param exp The exponent (non-negative).
+     * @return The result of (base^exp) % mod.
+     */
+    [[nodiscard]]
+    mpz_class operator()(const mpz_class &exp) const;
+
+protected:
+    mpz_class base, mod;
+    unsigned window; ///< Window size in bits
+    std::vector<mpz_class> table; ///< table[i] = base^(2^(window * i)) % mod
+};
+
+/**
+ * @brief Montgomery arithmetic context for a fixed odd modulus.
+ *
+ * Precomputes the Montgomery constants (-m^-1 mod 2^limb_bits and R^2 mod m) once per modulus and runs a sliding
+ * window exponentiation directly on limb arrays. The working limbs live in a per-thread scratch buffer that is grown
+ * on first use and reused afterwards, so repeated exponentiations against the same modulus repeat neither the setup
+ * nor the heap allocations of mpz_powm(). The context itself is immutable and can be shared by any number of
+ * threads. Even moduli (and a default-constructed context) fall back to powm().
+ */
+class montgomery_context {
+public:
+    montgomery_context() = default;
+
+    /**
+     * @brief Precomputes the constants for the given modulus.
+     * @param mod The modulus m (greater than 1).
+     */
+    explicit montgomery_context(const mpz_class &mod);
+
+    /**
+     * @brief Returns the modulus.
+     */
+    [[nodiscard]]
+    const mpz_class &modulus() const;
+
+    /**
+     * @brief Computes (base^exp) % mod.
+     * @param base The base number.
+     * @param exp The exponent.
+     * @return The result of (base^exp) % mod.
+     */
+    [[nodiscard]]
+    mpz_class powm(const mpz_class &base, const mpz_class &exp) const;
+
+protected:
+    mpz_class mod;
+    std::vector<mp_limb_t> m; ///< Limbs of the modulus
+    std::vector<mp_limb_t> r2; ///< R^2 mod m with R = 2^(limb_bits * m.size())
+    mp_limb_t m_inv = 0; ///< -m^-1 mod 2^limb_bits
+
+private:
+    /**
+     * @brief Montgomery reduction: r = t * R^-1 mod m.
+     * @param[out] r Result (m.size() limbs).
+     * @param[in,out] t Input of 2 * m.size() limbs, destroyed.
+     */
+    void redc(mp_limb_t *r, mp_limb_t *t) const;
+
+    /**
+     * @brief Montgomery multiplication: r = a * b * R^-1 mod m.
+     * @param[out] r Result (m.size() limbs, may alias a or b).
+     * @param a First operand.
+     * @param b Second operand.
+     * @param t Scratch of 2 * m.size() limbs.
+     */
+    void mul(mp_limb_t *r, const mp_limb_t *a, const mp_limb_t *b, mp_limb_t *t) const;
+};
+
 /**
  * @brief Generates a random prime number with a specified number of bytes.
  * @param b The number of bytes.
@@ -36,6 +135,48 @@ mpz_class powm(const mpz_class &base, const mpz_class &exp, const mpz_class &mod
 [[nodiscard]]
 mpz_class random_prime(unsigned b);
 
+/**
+ * @brief Generates a random prime number of exactly the given bit length.
+ *
+ * The two most significant bits are set, so the product of two such primes has exactly twice the bit length.
+ * Candidates are sieved incrementally against a table of small primes and only the survivors are passed to the
+ * Miller-Rabin/BPSW test. Several threads search from independent random starting points and the first prime
+ * found wins.
+ *
+ * @param bits The bit length of the prime.
+ * @param threads The number of threads to search with (0: hardware concurrency).
+ * @return A random prime number.
+ */
+[[nodiscard]]
+mpz_class generate_prime(size_t bits, unsigned threads = 0);
+
+/**
+ * @brief Converts an mpz_class number to a fixed-size big endian array.
+ *
+ * The number is exported with mpz_export and zero-padded on the left. If it does not fit, only the low-order bytes
+ * are written, i.e. the result is n mod 256^size.
+ *
+ * @param n The number to convert (non-negative).
+ * @param[out] out The output bytes.
+ */
+void mpz2bnd(const mpz_class &n, std::span<unsigned char> out);
+
+/**
+ * @brief Converts a big endian array to an mpz_class number with mpz_import.
+ * @param in The input bytes.
+ * @return The resulting mpz_class number.
+ */
+[[nodiscard]]
+mpz_class bnd2mpz(std::span<const unsigned char> in);
+
+/**
+ * @brief Converts little endian limbs to an mpz_class number, e.g. constexpr parameters without parsing a string.
+ * @param limbs The limbs, least significant first.
+ * @return The resulting mpz_class number.
+ */
+[[nodiscard]]
+mpz_class limbs2mpz(std::span<const mp_limb_t> limbs);
+
 /**
  * @brief Converts an mpz_class number to a big endian array.
  * @tparam It Iterator type.
@@ -44,9 +185,33 @@ mpz_class random_prime(unsigned b);
  * @param[out] end The end of the array.
  */
 template<typename It>
-void mpz2bnd(mpz_class n, It begin, It end) {
-    for (It i = end; i != begin; n /= 0x100) {
-        *--i = mpz_class{n % 0x100}.get_ui();
+void mpz2bnd(const mpz_class &n, It begin, It end) {
+    if constexpr (std::contiguous_iterator<It> && sizeof(std::iter_value_t<It>) == 1) {
+        mpz2bnd(n, std::span{reinterpret_cast<unsigned char *>(std::to_address(begin)),
+                             static_cast<size_t>(end - begin)});
+    } else {
+        std::vector<unsigned char> v(std::distance(begin, end));
+        mpz2bnd(n, std::span{v});
+        std::copy(v.begin(), v.end(), begin);
+    }
+}
+
+/**
+ * @brief Converts a fixed-width integer to a big endian array without going through GMP.
+ *
+ * Like the mpz_class version, bytes beyond the width of the array are discarded.
+ *
+ * @tparam T Integer type.
+ * @tparam It Iterator type.
+ * @param n The number to convert.
+ * @param[out] begin The beginning of the array.
+ * @param[out] end The end of the array.
+ */
+template<std::integral T, typename It>
+void mpz2bnd(T n, It begin, It end) {
+    auto v = static_cast<std::make_unsigned_t<T>>(n);
+    for (It i = end; i != begin; v = static_cast<decltype(v)>(v >> 8)) {
+        *--i = static_cast<unsigned char>(v);
     }
 }
 
@@ -60,12 +225,33 @@ void mpz2bnd(mpz_class n, It begin, It end) {
 template<typename It>
 [[nodiscard]]
 mpz_class bnd2mpz(It begin, It end) {
-    std::stringstream ss;
-    ss << "0x";
-    for (It i = begin; i != end; ++i) {
-        ss << std::hex << std::setfill('0') << std::setw(2) << +*i;
+    if constexpr (std::contiguous_iterator<It> && sizeof(std::iter_value_t<It>) == 1) {
+        return bnd2mpz(std::span{reinterpret_cast<const unsigned char *>(std::to_address(begin)),
+                                 static_cast<size_t>(end - begin)});
+    } else {
+        const std::vector<unsigned char> v(begin, end);
+        return bnd2mpz(std::span{v});
     }
-    return mpz_class{ss.str()};
+}
+
+/**
+ * @brief Converts a big endian array to a fixed-width unsigned integer without going through GMP.
+ *
+ * Leading bytes that do not fit into T are discarded.
+ *
+ * @tparam T Unsigned integer type.
+ * @tparam It Iterator type.
+ * @param begin The beginning of the array.
+ * @param end The end of the array.
+ * @return The resulting integer.
+ */
+template<std::unsigned_integral T, typename It>
+[[nodiscard]]
+T bnd2int(It begin, It end) {
+    T r = 0;
+    for (It i = begin; i != end; ++i)
+        r = static_cast<T>(r << 8 | static_cast<unsigned char>(*i));
+    return r;
 }
 
 /**
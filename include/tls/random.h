@@ -0,0 +1,42 @@
+//
+// Created by wtchr on 10/19/2026.
+//
+
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstddef>
+#include <gmpxx.h>
+#include <span>
+
+
+/**
+ * @brief Fills the output with cryptographically secure random bytes.
+ *
+ * Each thread owns a buffered ChaCha20 generator. It is seeded from the operating system (getrandom on Linux),
+ * rekeys itself after every refill so that earlier output cannot be reconstructed, and reseeds after a fixed
+ * amount of output. A child process created by fork() reseeds before its first draw, so parent and child never
+ * share a stream. All key, nonce and prime generation draws from here.
+ *
+ * @param[out] out The bytes to fill.
+ */
+void random_bytes(std::span<unsigned char> out);
+
+/**
+ * @brief Draws a uniformly distributed random number with the given number of bits.
+ * @param bits The number of bits.
+ * @return A random number in [0, 2^bits).
+ */
+[[nodiscard]]
+mpz_class random_bits(size_t bits);
+
+/**
+ * @brief Draws a uniformly distributed random number below the given bound by rejection sampling.
+ * @param n The exclusive upper bound (positive).
+ * @return A random number in [0, n).
+ */
+[[nodiscard]]
+mpz_class random_below(const mpz_class &n);
+
+
+#endif
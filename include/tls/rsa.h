@@ -6,24 +6,66 @@
 #define RSA_H
 
 #include <gmpxx.h>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+#include "tls/mpz.h"
 
 
 /**
  * @brief A class that implements RSA encryption and decryption.
+ *
+ * When the prime factors are known (a generated key, or one imported with its CRT parameters), the private
+ * operation runs modulo each prime with the reduced exponents dp and dq, and the two halves are recombined with
+ * Garner's formula (RFC 8017, section 5.1.2). Each half-size exponentiation costs about an eighth of one over the
+ * full modulus. Multi-prime keys with 3 or 4 factors are handled the same way, with a further Garner step for every
+ * additional prime, so a 4096-bit key with 4 primes needs four 1024-bit exponentiations.
+ *
+ * The private operation is written against GMP's mpn_sec_* functions (fixed-window mpn_sec_powm, mpn_sec_mul,
+ * mpn_sec_div_r), so its instruction sequence and memory accesses depend only on the sizes of the key. The limbs of
+ * every modulus, exponent and coefficient are laid out once per key, and the scratch space lives in a per-thread
+ * buffer sized for the key, so signing does not allocate once a thread has signed with a key of that size. Base
+ * blinding can be enabled on top; its factors are cached and updated by squaring after each use.
  */
 class rsa_class {
 public:
+    /// Largest supported number of prime factors.
+    static constexpr unsigned max_primes = 4;
+
+    /**
+     * @brief CRT parameters of a prime factor beyond p and q (RFC 8017 OtherPrimeInfo).
+     */
+    struct other_prime {
+        mpz_class r; ///< The prime factor r_i
+        mpz_class d; ///< Its CRT exponent, d mod (r_i - 1)
+        mpz_class t; ///< Its CRT coefficient, (r_1 * ... * r_(i-1))^-1 mod r_i
+    };
+
     mpz_class K, e;
 
     /**
      * @brief Constructs an RSA object with a specified key size.
      *
-     * This constructor generates two random prime numbers, computes the modulus,
-     * the totient, and the public and private exponents.
+     * This constructor generates two random prime numbers of key_size / 2 bytes each (or key_size / primes bytes
+     * for a multi-prime key), so that the modulus has 8 * key_size bits, and computes the totient and the public
+     * and private exponents.
      *
-     * @param key_size The size of the RSA key in bits.
+     * @param key_size The size of the modulus in bytes.
+     * @param primes The number of prime factors, from 2 to max_primes.
+     * @throws std::invalid_argument If the number of primes is not supported.
+     */
+    explicit rsa_class(int key_size, unsigned primes = 2);
+
+    /**
+     * @brief Generates a key whose modulus has exactly the given number of bits.
+     * @param bits The size of the modulus in bits.
+     * @param primes The number of prime factors, from 2 to max_primes.
+     * @return The new key.
+     * @throws std::invalid_argument If the number of primes is not supported.
      */
-    explicit rsa_class(int key_size);
+    [[nodiscard]]
+    static rsa_class generate(size_t bits, unsigned primes = 2);
 
     /**
      * @brief Constructs an RSA object with provided public and private keys.
@@ -33,6 +75,23 @@ public:
      */
     rsa_class(const mpz_class &e, const mpz_class &d, const mpz_class &K);
 
+    /**
+     * @brief Constructs an RSA object from a private key with CRT parameters, as in RFC 8017 RSAPrivateKey.
+     * @param e The public exponent.
+     * @param d The private exponent.
+     * @param K The modulus.
+     * @param p The first prime factor.
+     * @param q The second prime factor.
+     * @param dp The first factor's CRT exponent, d mod (p - 1).
+     * @param dq The second factor's CRT exponent, d mod (q - 1).
+     * @param q_inv The CRT coefficient, q^-1 mod p.
+     * @param others The parameters of the third and fourth prime of a multi-prime key.
+     * @throws std::invalid_argument If the parameters are inconsistent with each other.
+     */
+    rsa_class(const mpz_class &e, const mpz_class &d, const mpz_class &K, const mpz_class &p, const mpz_class &q,
+              const mpz_class &dp, const mpz_class &dq, const mpz_class &q_inv,
+              std::span<const other_prime> others = {});
+
     /**
      * @brief Signs a message by decoding it with the private key.
      * @param m The message to be signed.
@@ -41,6 +100,22 @@ public:
     [[nodiscard]]
     mpz_class sign(const mpz_class &m) const;
 
+    /**
+     * @brief Signs a big endian encoded message, such as an already padded digest.
+     * @param m The message bytes to be signed.
+     * @return The signed message.
+     */
+    [[nodiscard]]
+    mpz_class sign(std::span<const unsigned char> m) const;
+
+    /**
+     * @brief Signs a big endian encoded message into a caller-provided buffer, without allocating memory.
+     * @param m The message bytes; their value must be less than K.
+     * @param[out] out Receives the big endian signature; it must be exactly as long as the modulus.
+     * @throws std::invalid_argument If out has the wrong size or the message is not less than K.
+     */
+    void sign(std::span<const unsigned char> m, std::span<unsigned char> out) const;
+
     /**
      * @brief Encodes a message using the public key.
      * @param m The message to be encoded.
@@ -57,8 +132,71 @@ public:
     [[nodiscard]]
     mpz_class decode(const mpz_class &m) const;
 
+    /**
+     * @brief Enables or disables base blinding of the private operation.
+     *
+     * With blinding, the input is multiplied by A = r^e for a random r before the exponentiation and the result by
+     * A^-1 = r^-1 afterwards. Both factors are then squared for the next call, which costs two modular squarings
+     * instead of a fresh exponentiation and inversion. Copies of the object share the factors.
+     *
+     * @param enable Whether to blind.
+     */
+    void set_blinding(bool enable);
+
 protected:
     mpz_class p, q, d, phi;
+    mpz_class dp, dq, q_inv; ///< CRT exponents and coefficient; zero if the factors are unknown
+    montgomery_context mont; ///< Montgomery constants for K, used by the public operation and blinding
+    std::vector<other_prime> others; ///< Further prime factors of a multi-prime key
+
+    /**
+     * @brief One modulus of the private operation, in limbs: m_i = c^exp mod mod, then folded into the result
+     * with m += product * (coeff * (m_i - m) mod mod).
+     */
+    struct crt_step {
+        std::vector<mp_limb_t> mod; ///< A prime factor, or K if the factors are unknown
+        std::vector<mp_limb_t> exp; ///< The exponent modulo mod
+        mp_bitcnt_t exp_bits; ///< Bits of exp processed by mpn_sec_powm
+        std::vector<mp_limb_t> coeff; ///< Garner coefficient; empty for the first step
+        std::vector<mp_limb_t> product; ///< Product of the moduli of the preceding steps
+    };
+
+    /// Cached blinding factors, updated under the lock.
+    struct blinding_factors {
+        std::mutex lock;
+        std::vector<mp_limb_t> A, A_inv; ///< r^e mod K and r^-1 mod K
+    };
+
+    std::vector<crt_step> steps; ///< q, p and the further primes; or only K
+    std::vector<mp_limb_t> k_limbs; ///< Limbs of K
+    size_t scratch_limbs = 0; ///< Per-thread scratch needed by private_op()
+    std::shared_ptr<blinding_factors> blinding; ///< Null if blinding is disabled
+
+private:
+    rsa_class() = default;
+
+    /**
+     * @brief Generates the primes and exponents of a key.
+     * @param bits The size of the modulus in bits.
+     * @param primes The number of prime factors.
+     */
+    void generate_key(size_t bits, unsigned primes);
+
+    /**
+     * @brief Computes the CRT parameters from the prime factors and d.
+     */
+    void init_crt();
+
+    /**
+     * @brief Lays out the limbs of the private key for private_op() and sizes its scratch.
+     */
+    void init_private();
+
+    /**
+     * @brief Computes x^d mod K in place in constant time.
+     * @param[in,out] x The input, less than K, in as many limbs as K; receives the result.
+     */
+    void private_op(mp_limb_t *x) const;
 };
 
 
@@ -5,8 +5,12 @@
 #ifndef SHA_H
 #define SHA_H
 
+#include <algorithm>
 #include <array>
-#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
 #include "tls/network_utils.h"
 
 
@@ -25,6 +29,29 @@ public:
      */
     sha1();
 
+    /**
+     * @brief Resets the internal state to start a new message.
+     */
+    void init();
+
+    /**
+     * @brief Absorbs more input data into the running hash.
+     *
+     * Full blocks of contiguous input are fed straight into the compression function without being copied.
+     *
+     * @tparam It Iterator type for the input data.
+     * @param begin Iterator pointing to the beginning of the input data.
+     * @param end Iterator pointing to the end of the input data.
+     */
+    template<class It>
+    void update(It begin, It end);
+
+    /**
+     * @brief Pads the absorbed data and returns the digest. The object is reset afterwards.
+     * @return The SHA-1 hash digest as an array of bytes.
+     */
+    std::array<unsigned char, output_size> digest();
+
     /**
      * @brief Computes the SHA-1 hash of the input data.
      * @tparam It Iterator type for the input data.
@@ -37,7 +64,10 @@ public:
 
 protected:
     bool big_endian = false; ///< Indicates if the system is big-endian.
-    uint32_t h[5], w[80]; ///< Internal state and message schedule array.
+    uint32_t h[5]; ///< Internal state.
+    unsigned char buffer[block_size]; ///< Pending bytes of an incomplete block
+    size_t buffer_len = 0; ///< Number of bytes in buffer
+    uint64_t total_len = 0; ///< Number of bytes absorbed so far
     // Initial hash values
     static constexpr uint32_t h_stored_value[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
     // Round constants
@@ -45,34 +75,40 @@ protected:
 
 private:
     /**
-     * @brief Preprocesses the input data by padding and appending the length.
-     * @param[in,out] v The input data to preprocess.
+     * @brief Absorbs a contiguous byte range.
+     * @param p Pointer to the data.
+     * @param len Length of the data.
      */
-    static void preprocess(std::vector<unsigned char> &v);
+    void absorb(const unsigned char *p, size_t len);
 
     /**
      * @brief Processes a single 512-bit chunk of the input data.
-     * @param[in,out] p Pointer to the chunk to process.
+     * @param p Pointer to the chunk to process.
      */
-    void process_chunk(unsigned char *p);
+    void process_chunk(const unsigned char *p);
 };
 
+template<class It>
+void sha1::update(It begin, It end) {
+    if constexpr (std::contiguous_iterator<It> && sizeof(std::iter_value_t<It>) == 1) {
+        absorb(reinterpret_cast<const unsigned char *>(std::to_address(begin)), end - begin);
+    } else {
+        for (; begin != end; ++begin) {
+            buffer[buffer_len++] = static_cast<unsigned char>(*begin);
+            ++total_len;
+            if (buffer_len == block_size) {
+                process_chunk(buffer);
+                buffer_len = 0;
+            }
+        }
+    }
+}
+
 template<class It>
 std::array<unsigned char, sha1::output_size> sha1::hash(It begin, It end) {
-    for (int i = 0; i < 5; ++i)
-        h[i] = h_stored_value[i];
-    std::vector<unsigned char> msg{begin, end};
-    preprocess(msg);
-    for (int i = 0; i < msg.size(); i += block_size)
-        process_chunk(&msg[i]);
-    if (!big_endian)
-        for (auto &p : h)
-            p = htonl(p);
-    std::array<unsigned char, output_size> digest{};
-    auto *p = reinterpret_cast<unsigned char *>(h);
-    for (int i = 0; i < 20; ++i, ++p)
-        digest[i] = *p;
-    return digest;
+    init();
+    update(begin, end);
+    return digest();
 }
 
 
@@ -5,9 +5,12 @@
 #ifndef SHA2_BASE_H
 #define SHA2_BASE_H
 
+#include <algorithm>
 #include <array>
+#include <cstddef>
 #include <cstdint>
-#include <vector>
+#include <iterator>
+#include <memory>
 #include "tls/network_utils.h"
 
 // Define the operations used in the SHA-2 hash computation.
@@ -85,10 +88,34 @@ public:
     using WORD = std::conditional_t<BLOCK_SIZE == 64, uint32_t, uint64_t>;
 
     static constexpr size_t block_size = BLOCK_SIZE;
+    static constexpr size_t output_size = OUTPUT_SIZE;
     static constexpr size_t W_SIZE = BLOCK_SIZE == 64 ? 64 : 80;
 
     sha2_base();
 
+    /**
+     * @brief Resets the internal state to start a new message.
+     */
+    void init();
+
+    /**
+     * @brief Absorbs more input data into the running hash.
+     *
+     * Full blocks of contiguous input are fed straight into the compression function without being copied.
+     *
+     * @tparam It Iterator type for the input data.
+     * @param begin Iterator pointing to the beginning of the input data.
+     * @param end Iterator pointing to the end of the input data.
+     */
+    template<class It>
+    void update(It begin, It end);
+
+    /**
+     * @brief Pads the absorbed data and returns the digest. The object is reset afterwards.
+     * @return The SHA-2 hash as an array of bytes.
+     */
+    std::array<BYTE, OUTPUT_SIZE> digest();
+
     /**
      * @brief Computes the SHA-2 hash of the input data.
      * @tparam It Iterator type for the input data.
@@ -103,66 +130,116 @@ protected:
     bool big_endian = false; ///< Indicates if the system is big-endian.
 
     WORD H[8]; ///< Hash values
-    WORD W[W_SIZE]; ///< Message schedule
+    BYTE buffer[BLOCK_SIZE]; ///< Pending bytes of an incomplete block
+    size_t buffer_len = 0; ///< Number of bytes in buffer
+    uint64_t total_len = 0; ///< Number of bytes absorbed so far
 
 private:
     /**
-     * @brief Preprocesses the input data by padding.
-     * @param[in,out] v The input data to preprocess.
+     * @brief Absorbs a contiguous byte range.
+     * @param p Pointer to the data.
+     * @param len Length of the data.
      */
-    static void preprocess(std::vector<BYTE> &v);
+    void absorb(const BYTE *p, size_t len);
 
     /**
      * @brief Processes a single chunk of the input data.
-     * @param[in,out] p Pointer to the chunk to process.
+     * @param p Pointer to the chunk to process.
      */
-    void process_chunk(BYTE *p);
+    void process_chunk(const BYTE *p);
 };
 
 template<class Derived, size_t BLOCK_SIZE, size_t OUTPUT_SIZE>
 sha2_base<Derived, BLOCK_SIZE, OUTPUT_SIZE>::sha2_base() {
     if (constexpr uint32_t k = 0x12345678; htonl(k) == k)
         big_endian = true;
+    init();
+}
+
+template<class Derived, size_t BLOCK_SIZE, size_t OUTPUT_SIZE>
+void sha2_base<Derived, BLOCK_SIZE, OUTPUT_SIZE>::init() {
+    std::copy_n(Derived::h_stored_value, 8, H);
+    buffer_len = 0;
+    total_len = 0;
 }
 
 template<class Derived, size_t BLOCK_SIZE, size_t OUTPUT_SIZE>
 template<class It>
-std::array<unsigned char, OUTPUT_SIZE> sha2_base<Derived, BLOCK_SIZE, OUTPUT_SIZE>::hash(It begin, It end) {
-    auto *t = reinterpret_cast<Derived *>(this);
-    std::vector<BYTE> v{begin, end};
-    preprocess(v);
-    std::copy_n(t->h_stored_value, 8, H);
-    for (int i = 0; i < v.size(); i += BLOCK_SIZE)
-        t->process_chunk(&v[i]);
-    if (!big_endian)
-        for (auto &p : H)
-            p = htonl(p);
-    std::array<BYTE, OUTPUT_SIZE> digest{};
-    auto *p = reinterpret_cast<BYTE *>(H);
-    for (int i = 0; i < OUTPUT_SIZE; ++i, ++p)
-        digest[i] = *p;
-    return digest;
+void sha2_base<Derived, BLOCK_SIZE, OUTPUT_SIZE>::update(It begin, It end) {
+    if constexpr (std::contiguous_iterator<It> && sizeof(std::iter_value_t<It>) == 1) {
+        absorb(reinterpret_cast<const BYTE *>(std::to_address(begin)), end - begin);
+    } else {
+        for (; begin != end; ++begin) {
+            buffer[buffer_len++] = static_cast<BYTE>(*begin);
+            ++total_len;
+            if (buffer_len == BLOCK_SIZE) {
+                process_chunk(buffer);
+                buffer_len = 0;
+            }
+        }
+    }
 }
 
 template<class Derived, size_t BLOCK_SIZE, size_t OUTPUT_SIZE>
-void sha2_base<Derived, BLOCK_SIZE, OUTPUT_SIZE>::preprocess(std::vector<BYTE> &v) {
-    const size_t len = v.size();
-    v.push_back(0x80);
-    size_t padding_size = BLOCK_SIZE - (len + 1) % BLOCK_SIZE;
-    if (padding_size < BLOCK_SIZE / 8)
-        padding_size += BLOCK_SIZE;
-    v.resize(len + 1 + padding_size, 0);
-    mpz2bnd(static_cast<unsigned long>(len * 8), v.end() - BLOCK_SIZE / 8, v.end());
+void sha2_base<Derived, BLOCK_SIZE, OUTPUT_SIZE>::absorb(const BYTE *p, size_t len) {
+    total_len += len;
+    // Complete the pending block first.
+    if (buffer_len) {
+        const size_t n = std::min(len, BLOCK_SIZE - buffer_len);
+        std::copy_n(p, n, buffer + buffer_len);
+        buffer_len += n;
+        p += n;
+        len -= n;
+        if (buffer_len < BLOCK_SIZE)
+            return;
+        process_chunk(buffer);
+        buffer_len = 0;
+    }
+    for (; len >= BLOCK_SIZE; p += BLOCK_SIZE, len -= BLOCK_SIZE)
+        process_chunk(p);
+    std::copy_n(p, len, buffer);
+    buffer_len = len;
+}
+
+template<class Derived, size_t BLOCK_SIZE, size_t OUTPUT_SIZE>
+std::array<unsigned char, OUTPUT_SIZE> sha2_base<Derived, BLOCK_SIZE, OUTPUT_SIZE>::digest() {
+    // Append the bit '1', pad with zeros and write the message length in bits to the end of the last block.
+    // The length field is BLOCK_SIZE / 8 bytes long; only the low 64 bits can be non-zero here.
+    const uint64_t bits = total_len * 8;
+    buffer[buffer_len++] = 0x80;
+    if (buffer_len > BLOCK_SIZE - BLOCK_SIZE / 8) {
+        std::fill(buffer + buffer_len, buffer + BLOCK_SIZE, 0);
+        process_chunk(buffer);
+        buffer_len = 0;
+    }
+    std::fill(buffer + buffer_len, buffer + BLOCK_SIZE - 8, 0);
+    for (int i = 0; i < 8; ++i)
+        buffer[BLOCK_SIZE - 1 - i] = static_cast<BYTE>(bits >> 8 * i);
+    process_chunk(buffer);
+
+    std::array<BYTE, OUTPUT_SIZE> result{};
+    for (size_t i = 0; i < OUTPUT_SIZE; ++i)
+        result[i] = static_cast<BYTE>(H[i / sizeof(WORD)] >> 8 * (sizeof(WORD) - 1 - i % sizeof(WORD)));
+    init();
+    return result;
+}
+
+template<class Derived, size_t BLOCK_SIZE, size_t OUTPUT_SIZE>
+template<class It>
+std::array<unsigned char, OUTPUT_SIZE> sha2_base<Derived, BLOCK_SIZE, OUTPUT_SIZE>::hash(It begin, It end) {
+    init();
+    update(begin, end);
+    return digest();
 }
 
 template<class Derived, size_t BLOCK_SIZE, size_t OUTPUT_SIZE>
-void sha2_base<Derived, BLOCK_SIZE, OUTPUT_SIZE>::process_chunk(BYTE *p) {
-    auto *t = reinterpret_cast<Derived *>(this);
+void sha2_base<Derived, BLOCK_SIZE, OUTPUT_SIZE>::process_chunk(const BYTE *p) {
     // Prepare the message schedule W.
+    WORD W[W_SIZE];
     std::copy_n(p, BLOCK_SIZE, reinterpret_cast<BYTE *>(W));
     if (!big_endian)
-        for (auto &w : W)
-            w = htonl(w);
+        for (size_t i = 0; i < 16; ++i)
+            W[i] = htonl(W[i]);
     for (size_t i = 16; i < W_SIZE; ++i)
         W[i] = ssig1(W[i - 2]) + W[i - 7] + ssig0(W[i - 15]) + W[i - 16];
 
@@ -171,7 +248,7 @@ void sha2_base<Derived, BLOCK_SIZE, OUTPUT_SIZE>::process_chunk(BYTE *p) {
 
     // Perform the main hash computation.
     for (size_t i = 0; i < W_SIZE; ++i) {
-        const WORD t1 = h + bsig1(e) + ch(e, f, g) + t->K[i] + W[i];
+        const WORD t1 = h + bsig1(e) + ch(e, f, g) + Derived::K[i] + W[i];
         const WORD t2 = bsig0(a) + maj(a, b, c);
         h = g;
         g = f;
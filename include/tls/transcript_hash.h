@@ -0,0 +1,66 @@
+//
+// Created by wtchr on 10/19/2026.
+//
+
+#ifndef TRANSCRIPT_HASH_H
+#define TRANSCRIPT_HASH_H
+
+#include <array>
+#include <concepts>
+#include "tls/sha/sha2.h"
+
+
+/**
+ * @brief Concept for the hash functions used by TLS handshake transcripts.
+ */
+template<typename Hash>
+concept TranscriptHashFunction = std::same_as<Hash, sha256> || std::same_as<Hash, sha384>;
+
+
+/**
+ * @brief Running hash over the handshake messages.
+ *
+ * Messages are absorbed incrementally. The current digest can be taken at any point by finishing a copy of the
+ * fixed-size hash context, so the running state is kept and earlier messages are never hashed again.
+ *
+ * @tparam Hash The hash function to be used (sha256 or sha384).
+ */
+template<TranscriptHashFunction Hash>
+class transcript_hash {
+public:
+    static constexpr size_t output_size = Hash::output_size;
+
+    /**
+     * @brief Appends handshake message bytes to the transcript.
+     * @tparam It Iterator type for the message.
+     * @param begin Iterator pointing to the beginning of the message.
+     * @param end Iterator pointing to the end of the message.
+     */
+    template<typename It>
+    void update(It begin, It end) {
+        ctx.update(begin, end);
+    }
+
+    /**
+     * @brief Computes the hash of all messages absorbed so far without consuming the running state.
+     * @return The transcript digest.
+     */
+    [[nodiscard]]
+    std::array<unsigned char, output_size> digest() const {
+        Hash h = ctx;
+        return h.digest();
+    }
+
+    /**
+     * @brief Clears the transcript.
+     */
+    void reset() {
+        ctx.init();
+    }
+
+protected:
+    Hash ctx; ///< Running hash state.
+};
+
+
+#endif
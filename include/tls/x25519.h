@@ -0,0 +1,58 @@
+//
+// Created by wtchr on 10/19/2026.
+//
+
+#ifndef X25519_H
+#define X25519_H
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+
+/**
+ * @brief A struct representing the X25519 key exchange (RFC 7748).
+ *
+ * Keys and the shared secret are 32-byte strings, as they appear on the wire in a TLS key_share. Scalar
+ * multiplication is a Montgomery ladder over the field of fe25519.h, so its instruction sequence and memory access
+ * pattern do not depend on any key.
+ */
+struct x25519 {
+    static constexpr size_t key_size = 32;
+    using key_type = std::array<unsigned char, key_size>;
+
+    key_type K{}; ///< Shared secret
+    const key_type x, y; ///< Private key and public key
+
+    /**
+     * @brief Constructs a new x25519 object with a random private key.
+     */
+    x25519();
+
+    /**
+     * @brief Constructs a new x25519 object from a given private key.
+     * @param private_key The private key; it is clamped when used, so any 32 bytes are valid.
+     */
+    explicit x25519(std::span<const unsigned char, key_size> private_key);
+
+    /**
+     * @brief Computes and sets the shared secret key from peer's public key.
+     * @param pub_key The peer's public key.
+     * @return The computed shared secret key.
+     * @throws std::invalid_argument If the shared secret is all zeros, i.e. the peer sent a point of small order
+     * (RFC 7748, section 6.1).
+     */
+    key_type set_peer_public_key(std::span<const unsigned char, key_size> pub_key);
+
+    /**
+     * @brief The X25519 function: multiplies the u-coordinate of a point by a clamped scalar.
+     * @param k The scalar.
+     * @param u The u-coordinate.
+     * @return The u-coordinate of the product.
+     */
+    [[nodiscard]]
+    static key_type scalar_mult(std::span<const unsigned char, key_size> k, std::span<const unsigned char, key_size> u);
+};
+
+
+#endif
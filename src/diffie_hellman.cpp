@@ -4,61 +4,348 @@
 
 #include "tls/diffie_hellman.h"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <stdexcept>
 #include <vector>
+#include "tls/fe256.h"
 #include "tls/mpz.h"
+#include "tls/random.h"
 
 // diffie_hellman
 
-const auto p_value = mpz_class{
-        "0xFFFFFFFFFFFFFFFFADF85458A2BB4A9AAFDC5620273D3CF1D8B9C583CE2D3695A9E13641146433FBCC939DCE249B3EF97D2FE363630C"
-        "75D8F681B202AEC4617AD3DF1ED5D5FD65612433F51F5F066ED0856365553DED1AF3B557135E7F57C935984F0C70E0E68B77E2A689DAF3"
-        "EFE8721DF158A136ADE73530ACCA4F483A797ABC0AB182B324FB61D108A94BB2C8E3FBB96ADAB760D7F4681D4F42A3DE394DF4AE56EDE7"
-        "6372BB190B07A7C8EE0A6D709E02FCE1CDF7E2ECC03404CD28342F619172FE9CE98583FF8E4F1232EEF28183C3FE3B1B4C6FAD733BB5FC"
-        "BC2EC22005C58EF1837D1683B2C6F34A26C1B2EFFA886B423861285C97FFFFFFFFFFFFFFFF"
+// The 2048-bit group of RFC 7919 (ffdhe2048), least significant limb first.
+constexpr std::array<mp_limb_t, 32> p_limbs{
+        0xffffffffffffffff, 0x886b423861285c97, 0xc6f34a26c1b2effa, 0xc58ef1837d1683b2,
+        0x3bb5fcbc2ec22005, 0xc3fe3b1b4c6fad73, 0x8e4f1232eef28183, 0x9172fe9ce98583ff,
+        0xc03404cd28342f61, 0x9e02fce1cdf7e2ec, 0x0b07a7c8ee0a6d70, 0xae56ede76372bb19,
+        0x1d4f42a3de394df4, 0xb96adab760d7f468, 0xd108a94bb2c8e3fb, 0xbc0ab182b324fb61,
+        0x30acca4f483a797a, 0x1df158a136ade735, 0xe2a689daf3efe872, 0x984f0c70e0e68b77,
+        0xb557135e7f57c935, 0x856365553ded1af3, 0x2433f51f5f066ed0, 0xd3df1ed5d5fd6561,
+        0xf681b202aec4617a, 0x7d2fe363630c75d8, 0xcc939dce249b3ef9, 0xa9e13641146433fb,
+        0xd8b9c583ce2d3695, 0xafdc5620273d3cf1, 0xadf85458a2bb4a9a, 0xffffffffffffffff,
 };
 
-diffie_hellman::diffie_hellman()
-    : p{p_value}
+static const mpz_class &p_value() {
+    static const mpz_class p = limbs2mpz(p_limbs);
+    return p;
+}
+
+// Powers of the generator 2 modulo p_value(), shared by every instance.
+static const fixed_base_powm &generator_powm() {
+    static const fixed_base_powm table{2, p_value(), 2048};
+    return table;
+}
+
+// Montgomery constants for p_value(), shared by every instance.
+static const montgomery_context &p_context() {
+    static const montgomery_context ctx{p_value()};
+    return ctx;
+}
+
+// Draws a uniformly random private exponent in [2, 2^bits).
+static mpz_class random_exponent(const size_t bits) {
+    assert(bits >= 2 && bits < mpz_sizeinbase(p_value().get_mpz_t(), 2));
+    mpz_class x;
+    do {
+        x = random_bits(bits);
+    } while (x < 2);
+    return x;
+}
+
+diffie_hellman::diffie_hellman(const size_t exponent_bits)
+    : p{p_value()}
     , g{2}
-    , x{random_prime(255)}
-    , y{powm(g, x, p)} {}
+    , x{random_exponent(exponent_bits)}
+    , y{generator_powm()(x)} {}
 
 mpz_class diffie_hellman::set_peer_public_key(const mpz_class &pub_key) {
-    this->K = powm(pub_key, x, p);
+    if (!validate_public_key(pub_key))
+        throw std::invalid_argument{"invalid Diffie-Hellman public key"};
+    this->K = p_context().powm(pub_key, x);
     return K;
 }
 
+bool diffie_hellman::validate_public_key(const mpz_class &pub_key, const bool full) const {
+    if (pub_key <= 1 || pub_key >= p - 1)
+        return false;
+    // p = 2q + 1, so the prime-order subgroup is the set of quadratic residues.
+    return !full || p_context().powm(pub_key, (p - 1) / 2) == 1;
+}
+
 // ec_field
 
-ec_field::ec_field(const mpz_class &a, const mpz_class &b, const mpz_class &mod) {
-    this->a = a;
-    this->b = b;
-    this->mod = mod;
+// Field helpers on operands in [0, m); results stay in [0, m). Additive ones avoid a division.
+
+static void mul_mod(mpz_class &r, const mpz_class &a, const mpz_class &b, const mpz_class &m) {
+    mpz_mul(r.get_mpz_t(), a.get_mpz_t(), b.get_mpz_t());
+    mpz_mod(r.get_mpz_t(), r.get_mpz_t(), m.get_mpz_t());
+}
+
+static void add_mod(mpz_class &r, const mpz_class &a, const mpz_class &b, const mpz_class &m) {
+    mpz_add(r.get_mpz_t(), a.get_mpz_t(), b.get_mpz_t());
+    if (mpz_cmp(r.get_mpz_t(), m.get_mpz_t()) >= 0)
+        mpz_sub(r.get_mpz_t(), r.get_mpz_t(), m.get_mpz_t());
+}
+
+static void sub_mod(mpz_class &r, const mpz_class &a, const mpz_class &b, const mpz_class &m) {
+    mpz_sub(r.get_mpz_t(), a.get_mpz_t(), b.get_mpz_t());
+    if (mpz_sgn(r.get_mpz_t()) < 0)
+        mpz_add(r.get_mpz_t(), r.get_mpz_t(), m.get_mpz_t());
+}
+
+// Whether a equals the number given by its limbs.
+static bool equals_limbs(const mpz_class &a, const std::array<mp_limb_t, 4> &limbs) {
+    return mpz_size(a.get_mpz_t()) == limbs.size() && mpn_cmp(mpz_limbs_read(a.get_mpz_t()), limbs.data(), 4) == 0;
+}
+
+ec_field::params::params(const mpz_class &a, const mpz_class &b, const mpz_class &mod)
+    : a{a}
+    , b{b}
+    , mod{mod}
+    , a_is_zero{a % mod == 0}
+    , a_is_minus_3{(a + 3) % mod == 0}
+    , arith{arithmetic::generic} {
+    if (a_is_minus_3 && equals_limbs(mod, p256_field::p))
+        arith = arithmetic::p256;
+    else if (a_is_zero && equals_limbs(mod, secp256k1_field::p))
+        arith = arithmetic::secp256k1;
+}
+
+ec_field::ec_field(const mpz_class &a, const mpz_class &b, const mpz_class &mod)
+    : curve{std::make_shared<const params>(a, b, mod)} {}
+
+const mpz_class &ec_field::modulus() const {
+    return curve->mod;
+}
+
+ec_field::arithmetic ec_field::field_arithmetic() const {
+    return curve->arith;
 }
 
 mpz_class ec_field::mod_inv(const mpz_class &z) const {
     mpz_class r;
-    mpz_invert(r.get_mpz_t(), z.get_mpz_t(), mod.get_mpz_t());
+    mpz_invert(r.get_mpz_t(), z.get_mpz_t(), curve->mod.get_mpz_t());
     return r;
 }
 
+ec_jacobian ec_field::to_jacobian(const ec_point &p) const {
+    const mpz_class &mod = curve->mod;
+    if (p.is_identity())
+        return {1, 1, 0};
+    mpz_class x = p.x, y = p.y;
+    mpz_mod(x.get_mpz_t(), x.get_mpz_t(), mod.get_mpz_t());
+    mpz_mod(y.get_mpz_t(), y.get_mpz_t(), mod.get_mpz_t());
+    return {x, y, 1};
+}
+
+ec_point ec_field::to_affine(const ec_jacobian &p) const {
+    const mpz_class &mod = curve->mod;
+    if (p.Z == 0)
+        return {0, mod, *this};
+    const mpz_class zi = mod_inv(p.Z);
+    mpz_class zi2, x, y;
+    mul_mod(zi2, zi, zi, mod);
+    mul_mod(x, p.X, zi2, mod);
+    mul_mod(y, p.Y, zi2, mod);
+    mul_mod(y, y, zi, mod);
+    return {x, y, *this};
+}
+
+std::vector<ec_point> ec_field::to_affine(const std::span<const ec_jacobian> p) const {
+    const mpz_class &mod = curve->mod;
+    // prefix[i] = product of the non-zero Z of p[0..i]; one inversion of the total recovers every 1 / Z.
+    std::vector<mpz_class> prefix(p.size());
+    mpz_class acc = 1;
+    for (size_t i = 0; i < p.size(); ++i) {
+        if (p[i].Z != 0)
+            mul_mod(acc, acc, p[i].Z, mod);
+        prefix[i] = acc;
+    }
+    mpz_class inv = mod_inv(acc), zi, zi2;
+    std::vector<ec_point> r(p.size(), ec_point{0, mod, *this});
+    for (size_t i = p.size(); i-- > 0;) {
+        if (p[i].Z == 0)
+            continue;
+        if (i > 0)
+            mul_mod(zi, inv, prefix[i - 1], mod);
+        else
+            zi = inv;
+        mul_mod(inv, inv, p[i].Z, mod);
+        mul_mod(zi2, zi, zi, mod);
+        mul_mod(r[i].x, p[i].X, zi2, mod);
+        mul_mod(r[i].y, p[i].Y, zi2, mod);
+        mul_mod(r[i].y, r[i].y, zi, mod);
+    }
+    return r;
+}
+
+void ec_field::dbl(ec_jacobian &p) const {
+    const mpz_class &mod = curve->mod;
+    if (p.Z == 0 || p.Y == 0) {
+        p.Z = 0;
+        return;
+    }
+    // Temporaries are kept per thread so that the hot loop does not allocate.
+    thread_local mpz_class xx, yy, yyyy, zz, s, m, t;
+    mul_mod(xx, p.X, p.X, mod);
+    mul_mod(yy, p.Y, p.Y, mod);
+    mul_mod(yyyy, yy, yy, mod);
+    mul_mod(zz, p.Z, p.Z, mod);
+    // S = 2 * ((X + YY)^2 - XX - YYYY) = 4 * X * YY
+    add_mod(s, p.X, yy, mod);
+    mul_mod(s, s, s, mod);
+    sub_mod(s, s, xx, mod);
+    sub_mod(s, s, yyyy, mod);
+    add_mod(s, s, s, mod);
+    // M = 3 * XX + a * ZZ^2
+    if (curve->a_is_minus_3) {
+        // 3 * (X - ZZ) * (X + ZZ)
+        add_mod(t, p.X, zz, mod);
+        sub_mod(m, p.X, zz, mod);
+        mul_mod(t, m, t, mod);
+        add_mod(m, t, t, mod);
+        add_mod(m, m, t, mod);
+    } else {
+        add_mod(m, xx, xx, mod);
+        add_mod(m, m, xx, mod);
+        if (!curve->a_is_zero) {
+            mul_mod(t, zz, zz, mod);
+            mul_mod(t, t, curve->a, mod);
+            add_mod(m, m, t, mod);
+        }
+    }
+    // Z3 = (Y + Z)^2 - YY - ZZ = 2 * Y * Z
+    add_mod(p.Z, p.Z, p.Y, mod);
+    mul_mod(p.Z, p.Z, p.Z, mod);
+    sub_mod(p.Z, p.Z, yy, mod);
+    sub_mod(p.Z, p.Z, zz, mod);
+    // X3 = M^2 - 2 * S, Y3 = M * (S - X3) - 8 * YYYY
+    mul_mod(p.X, m, m, mod);
+    sub_mod(p.X, p.X, s, mod);
+    sub_mod(p.X, p.X, s, mod);
+    sub_mod(s, s, p.X, mod);
+    mul_mod(p.Y, m, s, mod);
+    add_mod(yyyy, yyyy, yyyy, mod);
+    add_mod(yyyy, yyyy, yyyy, mod);
+    add_mod(yyyy, yyyy, yyyy, mod);
+    sub_mod(p.Y, p.Y, yyyy, mod);
+}
+
+void ec_field::add(ec_jacobian &p, const ec_jacobian &q) const {
+    const mpz_class &mod = curve->mod;
+    if (q.Z == 0)
+        return;
+    if (p.Z == 0) {
+        p = q;
+        return;
+    }
+    thread_local mpz_class z1z1, z2z2, u1, u2, s1, s2, h, i, j, r, v;
+    mul_mod(z1z1, p.Z, p.Z, mod);
+    mul_mod(z2z2, q.Z, q.Z, mod);
+    mul_mod(u1, p.X, z2z2, mod);
+    mul_mod(u2, q.X, z1z1, mod);
+    mul_mod(s1, p.Y, q.Z, mod);
+    mul_mod(s1, s1, z2z2, mod);
+    mul_mod(s2, q.Y, p.Z, mod);
+    mul_mod(s2, s2, z1z1, mod);
+    sub_mod(h, u2, u1, mod);
+    sub_mod(r, s2, s1, mod);
+    if (h == 0) {
+        if (r == 0)
+            dbl(p); // P == Q
+        else
+            p.Z = 0; // P == -Q
+        return;
+    }
+    add_mod(r, r, r, mod);
+    // I = (2 * H)^2, J = H * I, V = U1 * I
+    add_mod(i, h, h, mod);
+    mul_mod(i, i, i, mod);
+    mul_mod(j, h, i, mod);
+    mul_mod(v, u1, i, mod);
+    // Z3 = ((Z1 + Z2)^2 - Z1Z1 - Z2Z2) * H
+    add_mod(p.Z, p.Z, q.Z, mod);
+    mul_mod(p.Z, p.Z, p.Z, mod);
+    sub_mod(p.Z, p.Z, z1z1, mod);
+    sub_mod(p.Z, p.Z, z2z2, mod);
+    mul_mod(p.Z, p.Z, h, mod);
+    // X3 = r^2 - J - 2 * V, Y3 = r * (V - X3) - 2 * S1 * J
+    mul_mod(p.X, r, r, mod);
+    sub_mod(p.X, p.X, j, mod);
+    sub_mod(p.X, p.X, v, mod);
+    sub_mod(p.X, p.X, v, mod);
+    sub_mod(v, v, p.X, mod);
+    mul_mod(p.Y, r, v, mod);
+    mul_mod(s1, s1, j, mod);
+    sub_mod(p.Y, p.Y, s1, mod);
+    sub_mod(p.Y, p.Y, s1, mod);
+}
+
+void ec_field::add(ec_jacobian &p, const ec_point &q) const {
+    const mpz_class &mod = curve->mod;
+    if (q.is_identity())
+        return;
+    if (p.Z == 0) {
+        p = to_jacobian(q);
+        return;
+    }
+    thread_local mpz_class z1z1, u2, s2, h, hh, i, j, r, v;
+    mul_mod(z1z1, p.Z, p.Z, mod);
+    mul_mod(u2, q.x, z1z1, mod);
+    mul_mod(s2, q.y, p.Z, mod);
+    mul_mod(s2, s2, z1z1, mod);
+    sub_mod(h, u2, p.X, mod);
+    sub_mod(r, s2, p.Y, mod);
+    if (h == 0) {
+        if (r == 0)
+            dbl(p); // P == Q
+        else
+            p.Z = 0; // P == -Q
+        return;
+    }
+    add_mod(r, r, r, mod);
+    // HH = H^2, I = 4 * HH, J = H * I, V = X1 * I
+    mul_mod(hh, h, h, mod);
+    add_mod(i, hh, hh, mod);
+    add_mod(i, i, i, mod);
+    mul_mod(j, h, i, mod);
+    mul_mod(v, p.X, i, mod);
+    // Z3 = (Z1 + H)^2 - Z1Z1 - HH
+    add_mod(p.Z, p.Z, h, mod);
+    mul_mod(p.Z, p.Z, p.Z, mod);
+    sub_mod(p.Z, p.Z, z1z1, mod);
+    sub_mod(p.Z, p.Z, hh, mod);
+    // X3 = r^2 - J - 2 * V, Y3 = r * (V - X3) - 2 * Y1 * J
+    mul_mod(s2, p.Y, j, mod);
+    mul_mod(p.X, r, r, mod);
+    sub_mod(p.X, p.X, j, mod);
+    sub_mod(p.X, p.X, v, mod);
+    sub_mod(p.X, p.X, v, mod);
+    sub_mod(v, v, p.X, mod);
+    mul_mod(p.Y, r, v, mod);
+    sub_mod(p.Y, p.Y, s2, mod);
+    sub_mod(p.Y, p.Y, s2, mod);
+}
+
 // ec_point
 
 ec_point::ec_point(const mpz_class &x, const mpz_class &y, const ec_field &f)
     : ec_field(f) {
     // Assert the point is an element of the curve.
-    if (y != mod)
-        assert((y * y - (x * x * x + a * x + b)) % mod == 0);
+    if (y != curve->mod)
+        assert((y * y - (x * x * x + curve->a * x + curve->b)) % curve->mod == 0);
     this->x = x;
     this->y = y;
 }
 
 bool ec_point::is_identity() const {
-    return y == mod;
+    return y == curve->mod;
 }
 
 ec_point ec_point::operator+(const ec_point &r) const {
+    const mpz_class &mod = curve->mod;
     // y == mod: O (identity or infinity)
     if (r.y == mod)
         return *this; // P + O = P
@@ -68,7 +355,7 @@ ec_point ec_point::operator+(const ec_point &r) const {
     if (r == *this) {
         if (y == 0)
             return {x, mod, *this}; // Return identity
-        s = (3 * x * x + a) * mod_inv(2 * y) % mod;
+        s = (3 * x * x + curve->a) * mod_inv(2 * y) % mod;
     } else {
         if (x == r.x)
             return {x, mod, *this}; // Return identity
@@ -85,26 +372,637 @@ ec_point ec_point::operator+(const ec_point &r) const {
 
 bool ec_point::operator==(const ec_point &r) const {
     // Assert the points are on the same curve.
-    assert(a == r.a && b == r.b && mod == r.mod);
+    assert(curve == r.curve || (curve->a == r.curve->a && curve->b == r.curve->b && curve->mod == r.curve->mod));
+    if (is_identity() || r.is_identity())
+        return is_identity() == r.is_identity(); // The x-coordinate of the identity is arbitrary.
     return x == r.x && y == r.y;
 }
 
-ec_point operator*(const mpz_class &l, const ec_point &p) {
-    std::vector<bool> bits;
-    for (mpz_class n = l; n > 0; n /= 2) {
-        bits.push_back(n % 2 == 1);
+ec_point ec_point::operator-() const {
+    const mpz_class &mod = curve->mod;
+    if (is_identity())
+        return *this;
+    mpz_class ny = -y;
+    mpz_mod(ny.get_mpz_t(), ny.get_mpz_t(), mod.get_mpz_t());
+    return {x, ny, *this};
+}
+
+// Reads count (< limb size) bits of k starting at bit pos.
+static unsigned get_bits(const mpz_class &k, const size_t pos, const unsigned count) {
+    const size_t limb = pos / GMP_NUMB_BITS, shift = pos % GMP_NUMB_BITS;
+    mp_limb_t v = mpz_getlimbn(k.get_mpz_t(), static_cast<mp_size_t>(limb)) >> shift;
+    if (shift + count > GMP_NUMB_BITS)
+        v |= mpz_getlimbn(k.get_mpz_t(), static_cast<mp_size_t>(limb + 1)) << (GMP_NUMB_BITS - shift);
+    return static_cast<unsigned>(v & ((mp_limb_t{1} << count) - 1));
+}
+
+// Width-w NAF of k > 0, least significant digit first. Digits are zero or odd with |d| < 2^(w - 1), and every
+// non-zero digit is followed by at least w - 1 zeros. The carry replaces the subtractions of the textbook recoding,
+// so only w-bit windows of the limbs are read.
+static std::vector<int> wnaf(const mpz_class &k, const unsigned w) {
+    const size_t len = mpz_sizeinbase(k.get_mpz_t(), 2);
+    std::vector<int> naf(len + 1);
+    int carry = 0;
+    for (size_t bit = 0; bit < len;) {
+        if (static_cast<int>(mpz_tstbit(k.get_mpz_t(), bit)) == carry) {
+            ++bit;
+            continue;
+        }
+        const unsigned now = static_cast<unsigned>(std::min<size_t>(w, len - bit));
+        int word = static_cast<int>(get_bits(k, bit, now)) + carry;
+        carry = word >> (w - 1) & 1;
+        word -= carry << w;
+        naf[bit] = word;
+        bit += now;
+    }
+    naf[len] = carry;
+    return naf;
+}
+
+// Copies a reduced field element into n limbs.
+static void store_limbs(mp_limb_t *r, const mpz_class &a, const size_t n) {
+    std::fill_n(r, n, 0);
+    std::copy_n(mpz_limbs_read(a.get_mpz_t()), mpz_size(a.get_mpz_t()), r);
+}
+
+static void load_limbs(mpz_class &r, const mp_limb_t *a, const size_t n) {
+    mp_limb_t *d = mpz_limbs_write(r.get_mpz_t(), static_cast<mp_size_t>(n));
+    std::copy_n(a, n, d);
+    mpz_limbs_finish(r.get_mpz_t(), static_cast<mp_size_t>(n));
+}
+
+// Curve adapters: the scalar multiplications below are written once against this interface and instantiated for
+// the mpz arithmetic of ec_field and for the fixed-limb fields of fe256.h.
+
+namespace {
+
+// Point arithmetic on mpz_class numbers, for any curve.
+struct mpz_curve {
+    using jacobian = ec_jacobian;
+    using affine = ec_point;
+
+    const ec_field &f;
+
+    [[nodiscard]] size_t limbs() const { return mpz_size(f.modulus().get_mpz_t()); }
+    [[nodiscard]] const mp_limb_t *modulus_limbs() const { return mpz_limbs_read(f.modulus().get_mpz_t()); }
+    [[nodiscard]] static jacobian identity() { return {1, 1, 0}; }
+    [[nodiscard]] static affine import(const ec_point &p) { return p; }
+    [[nodiscard]] jacobian lift(const affine &p) const { return f.to_jacobian(p); }
+    [[nodiscard]] static affine neg(const affine &p) { return -p; }
+    void dbl(jacobian &p) const { f.dbl(p); }
+    void add(jacobian &p, const jacobian &q) const { f.add(p, q); }
+    void add(jacobian &p, const affine &q) const { f.add(p, q); }
+    [[nodiscard]] std::vector<affine> normalize(const std::span<const jacobian> p) const { return f.to_affine(p); }
+    [[nodiscard]] ec_point to_point(const jacobian &p) const { return f.to_affine(p); }
+    [[nodiscard]] static ec_jacobian to_mpz(const jacobian &p) { return p; }
+
+    // Writes the affine coordinates as 2 * limbs() limbs.
+    void store(mp_limb_t *r, const affine &p) const {
+        const size_t n = limbs();
+        store_limbs(r, p.x, n);
+        store_limbs(r + n, p.y, n);
+    }
+
+    void load(affine &r, const mp_limb_t *a) const {
+        const size_t n = limbs();
+        load_limbs(r.x, a, n);
+        load_limbs(r.y, a + n, n);
+    }
+
+    // Replaces p by q if cnd is set, without branching on cnd.
+    void cnd_assign(jacobian &p, const jacobian &q, const mp_limb_t cnd) const {
+        const size_t n = limbs();
+        std::vector<mp_limb_t> a(3 * n), b(3 * n);
+        const auto store = [n](mp_limb_t *r, const ec_jacobian &j) {
+            store_limbs(r, j.X, n);
+            store_limbs(r + n, j.Y, n);
+            store_limbs(r + 2 * n, j.Z, n);
+        };
+        store(a.data(), p);
+        store(b.data(), q);
+        mpn_cnd_swap(cnd, a.data(), b.data(), static_cast<mp_size_t>(3 * n));
+        load_limbs(p.X, a.data(), n);
+        load_limbs(p.Y, a.data() + n, n);
+        load_limbs(p.Z, a.data() + 2 * n, n);
+    }
+};
+
+// Point arithmetic on fe256 elements, with the same formulas as ec_field.
+template<class Field>
+struct fixed_curve {
+    using fe = fe256<Field>;
+
+    struct jacobian {
+        fe X, Y, Z;
+    };
+
+    struct affine {
+        fe x, y;
+        bool infinity = false;
+    };
+
+    const ec_field &f;
+
+    [[nodiscard]] static size_t limbs() { return 4; }
+    [[nodiscard]] static const mp_limb_t *modulus_limbs() { return Field::p.data(); }
+    [[nodiscard]] static jacobian identity() { return {fe::one(), fe::one(), fe{}}; }
+
+    [[nodiscard]] affine import(const ec_point &p) const {
+        if (p.is_identity())
+            return {fe{}, fe{}, true};
+        return {convert(p.x), convert(p.y)};
+    }
+
+    [[nodiscard]] static jacobian lift(const affine &p) {
+        return p.infinity ? identity() : jacobian{p.x, p.y, fe::one()};
+    }
+
+    [[nodiscard]] static affine neg(const affine &p) { return {p.x, fe{} - p.y, p.infinity}; }
+
+    static void dbl(jacobian &p);
+    static void add(jacobian &p, const jacobian &q);
+    static void add(jacobian &p, const affine &q);
+
+    [[nodiscard]] static std::vector<affine> normalize(std::span<const jacobian> p);
+
+    [[nodiscard]] ec_point to_point(const jacobian &p) const {
+        if (p.Z.is_zero())
+            return {0, f.modulus(), f};
+        const fe zi = p.Z.inv(), zi2 = zi.sqr();
+        return {(p.X * zi2).to_mpz(), (p.Y * zi2 * zi).to_mpz(), f};
+    }
+
+    [[nodiscard]] static ec_jacobian to_mpz(const jacobian &p) {
+        return {p.X.to_mpz(), p.Y.to_mpz(), p.Z.to_mpz()};
+    }
+
+    // Tables keep the internal representation, so loading an entry converts nothing.
+    static void store(mp_limb_t *r, const affine &p) {
+        std::copy_n(p.x.v.data(), 4, r);
+        std::copy_n(p.y.v.data(), 4, r + 4);
+    }
+
+    static void load(affine &r, const mp_limb_t *a) {
+        std::copy_n(a, 4, r.x.v.data());
+        std::copy_n(a + 4, 4, r.y.v.data());
+        r.infinity = false;
+    }
+
+    static void cnd_assign(jacobian &p, const jacobian &q, const mp_limb_t cnd) {
+        jacobian t = q;
+        mpn_cnd_swap(cnd, p.X.v.data(), t.X.v.data(), 4);
+        mpn_cnd_swap(cnd, p.Y.v.data(), t.Y.v.data(), 4);
+        mpn_cnd_swap(cnd, p.Z.v.data(), t.Z.v.data(), 4);
+    }
+
+private:
+    [[nodiscard]] fe convert(const mpz_class &a) const {
+        if (a >= 0 && a < f.modulus())
+            return fe::from_mpz(a);
+        mpz_class r;
+        mpz_mod(r.get_mpz_t(), a.get_mpz_t(), f.modulus().get_mpz_t());
+        return fe::from_mpz(r);
     }
-    ec_point r = {0, p.mod, p};
-    ec_point x = p;
-    for (auto bit : bits) {
-        if (bit)
-            r = r + x;
-        x = x + x; // Double the point
+};
+
+template<class Field>
+void fixed_curve<Field>::dbl(jacobian &p) {
+    // Z3 = 2 * Y * Z, which is zero for the identity and for points of order 2 without a special case.
+    const fe xx = p.X.sqr(), yy = p.Y.sqr(), yyyy = yy.sqr(), zz = p.Z.sqr();
+    fe s = (p.X + yy).sqr() - xx - yyyy;
+    s = s + s;
+    fe m;
+    if constexpr (Field::a_is_minus_3) {
+        const fe t = (p.X - zz) * (p.X + zz);
+        m = t + t + t;
+    } else {
+        m = xx + xx + xx;
+    }
+    fe y8 = yyyy + yyyy;
+    y8 = y8 + y8;
+    y8 = y8 + y8;
+    p.Z = (p.Y + p.Z).sqr() - yy - zz;
+    p.X = m.sqr() - s - s;
+    p.Y = m * (s - p.X) - y8;
+}
+
+template<class Field>
+void fixed_curve<Field>::add(jacobian &p, const jacobian &q) {
+    if (q.Z.is_zero())
+        return;
+    if (p.Z.is_zero()) {
+        p = q;
+        return;
+    }
+    const fe z1z1 = p.Z.sqr(), z2z2 = q.Z.sqr();
+    const fe u1 = p.X * z2z2, u2 = q.X * z1z1;
+    const fe s1 = p.Y * q.Z * z2z2, s2 = q.Y * p.Z * z1z1;
+    const fe h = u2 - u1;
+    fe r = s2 - s1;
+    if (h.is_zero()) {
+        if (r.is_zero())
+            dbl(p); // P == Q
+        else
+            p.Z = fe{}; // P == -Q
+        return;
+    }
+    r = r + r;
+    const fe i = (h + h).sqr(), j = h * i, v = u1 * i, s1j = s1 * j;
+    p.Z = ((p.Z + q.Z).sqr() - z1z1 - z2z2) * h;
+    p.X = r.sqr() - j - v - v;
+    p.Y = r * (v - p.X) - s1j - s1j;
+}
+
+template<class Field>
+void fixed_curve<Field>::add(jacobian &p, const affine &q) {
+    if (q.infinity)
+        return;
+    if (p.Z.is_zero()) {
+        p = lift(q);
+        return;
+    }
+    const fe z1z1 = p.Z.sqr();
+    const fe h = q.x * z1z1 - p.X;
+    fe r = q.y * p.Z * z1z1 - p.Y;
+    if (h.is_zero()) {
+        if (r.is_zero())
+            dbl(p); // P == Q
+        else
+            p.Z = fe{}; // P == -Q
+        return;
+    }
+    r = r + r;
+    const fe hh = h.sqr();
+    fe i = hh + hh;
+    i = i + i;
+    const fe j = h * i, v = p.X * i, yj = p.Y * j;
+    p.Z = (p.Z + h).sqr() - z1z1 - hh;
+    p.X = r.sqr() - j - v - v;
+    p.Y = r * (v - p.X) - yj - yj;
+}
+
+template<class Field>
+std::vector<typename fixed_curve<Field>::affine> fixed_curve<Field>::normalize(const std::span<const jacobian> p) {
+    // Montgomery's trick as in ec_field::to_affine().
+    std::vector<fe> prefix(p.size());
+    fe acc = fe::one();
+    for (size_t i = 0; i < p.size(); ++i) {
+        if (!p[i].Z.is_zero())
+            acc = acc * p[i].Z;
+        prefix[i] = acc;
+    }
+    fe inv = acc.inv();
+    std::vector<affine> r(p.size(), affine{fe{}, fe{}, true});
+    for (size_t i = p.size(); i-- > 0;) {
+        if (p[i].Z.is_zero())
+            continue;
+        const fe zi = i > 0 ? inv * prefix[i - 1] : inv, zi2 = zi.sqr();
+        inv = inv * p[i].Z;
+        r[i] = {p[i].X * zi2, p[i].Y * zi2 * zi};
+    }
+    return r;
+}
+
+// Odd multiples of a point and their negations, indexed by NAF digit.
+template<class Curve>
+struct wnaf_table {
+    std::vector<typename Curve::affine> pos, neg;
+
+    const typename Curve::affine &operator[](const int digit) const {
+        return digit > 0 ? pos[digit >> 1] : neg[-digit >> 1];
+    }
+};
+
+} // namespace
+
+// Calls fn with the adapter for the arithmetic of f.
+template<class Fn>
+static auto with_curve(const ec_field &f, Fn &&fn) {
+    switch (f.field_arithmetic()) {
+        case ec_field::arithmetic::p256:
+            return fn(fixed_curve<p256_field>{f});
+        case ec_field::arithmetic::secp256k1:
+            return fn(fixed_curve<secp256k1_field>{f});
+        default:
+            return fn(mpz_curve{f});
+    }
+}
+
+// Affine odd multiples P, 3P, ..., (2 * size - 1)P.
+template<class Curve>
+static std::vector<typename Curve::affine>
+odd_multiples(const Curve &c, const typename Curve::affine &p, const size_t size) {
+    std::vector<typename Curve::jacobian> t(size, c.lift(p));
+    auto p2 = t[0];
+    c.dbl(p2);
+    for (size_t i = 1; i < size; ++i) {
+        t[i] = t[i - 1];
+        c.add(t[i], p2);
+    }
+    return c.normalize(t);
+}
+
+template<class Curve>
+static wnaf_table<Curve> make_table(const Curve &c, const typename Curve::affine &p, const unsigned w) {
+    wnaf_table<Curve> t;
+    t.pos = odd_multiples(c, p, size_t{1} << (w - 2));
+    t.neg.reserve(t.pos.size());
+    for (const auto &q : t.pos)
+        t.neg.push_back(c.neg(q));
+    return t;
+}
+
+// Width of the tables mul_add() builds on the fly.
+constexpr unsigned on_the_fly_width = 5;
+
+static unsigned table_width(const ec_wnaf_table &t) {
+    return t.width();
+}
+
+static unsigned table_width(const ec_point &) {
+    return on_the_fly_width;
+}
+
+static const ec_point &table_point(const ec_wnaf_table &t) {
+    return t.point();
+}
+
+static const ec_point &table_point(const ec_point &p) {
+    return p;
+}
+
+// The odd multiples of a precomputed table or of a point, in the arithmetic of the adapter.
+
+static const ec_wnaf_table &import_table(const mpz_curve &, const ec_wnaf_table &t) {
+    return t;
+}
+
+static ec_wnaf_table import_table(const mpz_curve &, const ec_point &p) {
+    return {p, on_the_fly_width};
+}
+
+// Gives import_table() the fixed-limb table the ec_wnaf_table constructor built.
+struct ec_wnaf_table_access {
+    template<class Field>
+    static const wnaf_table<fixed_curve<Field>> &fixed(const ec_wnaf_table &t) {
+        static const wnaf_table<fixed_curve<Field>> empty;
+        // The table of the identity is empty; it is never indexed because its digits are empty too.
+        return t.fixed ? *static_cast<const wnaf_table<fixed_curve<Field>> *>(t.fixed.get()) : empty;
+    }
+};
+
+template<class Field>
+static const wnaf_table<fixed_curve<Field>> &import_table(const fixed_curve<Field> &, const ec_wnaf_table &t) {
+    return ec_wnaf_table_access::fixed<Field>(t);
+}
+
+template<class Field>
+static wnaf_table<fixed_curve<Field>> import_table(const fixed_curve<Field> &c, const ec_point &p) {
+    return make_table(c, c.import(p), on_the_fly_width);
+}
+
+// Interleaved NAF evaluation of sum nu[i] * 2^i * P + nv[i] * 2^i * Q with one doubling chain.
+template<class Curve, class TableP, class TableQ>
+static typename Curve::jacobian mul_add_loop(
+        const Curve &c, const std::vector<int> &nu, const TableP &p, const std::vector<int> &nv, const TableQ &q
+) {
+    auto r = c.identity();
+    for (size_t i = std::max(nu.size(), nv.size()); i-- > 0;) {
+        c.dbl(r);
+        if (i < nu.size() && nu[i])
+            c.add(r, p[nu[i]]);
+        if (i < nv.size() && nv[i])
+            c.add(r, q[nv[i]]);
     }
     return r;
 }
 
+ec_point operator*(const mpz_class &l, const ec_point &p) {
+    if (l <= 0 || p.is_identity())
+        return {0, p.modulus(), p};
+    const size_t bits = mpz_sizeinbase(l.get_mpz_t(), 2);
+    const unsigned w = bits > 128 ? 5 : bits > 32 ? 4 : 3;
+    const auto naf = wnaf(l, w);
+    return with_curve(p, [&](const auto &c) {
+        const auto table = make_table(c, c.import(p), w);
+        return c.to_point(mul_add_loop(c, naf, table, {}, table));
+    });
+}
+
+// ec_wnaf_table
+
+template<class Field>
+static std::shared_ptr<const void> make_fixed_table(const ec_point &p, const unsigned w) {
+    const fixed_curve<Field> c{p};
+    return std::make_shared<const wnaf_table<fixed_curve<Field>>>(make_table(c, c.import(p), w));
+}
+
+ec_wnaf_table::ec_wnaf_table(const ec_point &p, const unsigned w)
+    : p{p}
+    , w{w} {
+    assert(w >= 2);
+    if (p.is_identity())
+        return;
+    pos = odd_multiples(mpz_curve{p}, p, size_t{1} << (w - 2));
+    neg.reserve(pos.size());
+    for (const auto &t : pos)
+        neg.push_back(-t);
+    switch (p.field_arithmetic()) {
+        case ec_field::arithmetic::p256:
+            fixed = make_fixed_table<p256_field>(p, w);
+            break;
+        case ec_field::arithmetic::secp256k1:
+            fixed = make_fixed_table<secp256k1_field>(p, w);
+            break;
+        default:
+            break;
+    }
+}
+
+unsigned ec_wnaf_table::width() const {
+    return w;
+}
+
+const ec_point &ec_wnaf_table::operator[](const int digit) const {
+    return digit > 0 ? pos[digit >> 1] : neg[-digit >> 1];
+}
+
+const ec_point &ec_wnaf_table::point() const {
+    return p;
+}
+
+// u * P + v * Q where P and Q are each given as a precomputed table or as a point.
+template<class P, class Q>
+static ec_jacobian mul_add_any(const mpz_class &u, const P &p, const mpz_class &v, const Q &q) {
+    const auto recode = [](const mpz_class &k, const auto &t) {
+        return k > 0 && !table_point(t).is_identity() ? wnaf(k, table_width(t)) : std::vector<int>{};
+    };
+    const auto nu = recode(u, p), nv = recode(v, q);
+    return with_curve(table_point(p), [&](const auto &c) {
+        const auto &tp = import_table(c, p);
+        const auto &tq = import_table(c, q);
+        return c.to_mpz(mul_add_loop(c, nu, tp, nv, tq));
+    });
+}
+
+ec_jacobian mul_add_jacobian(const mpz_class &u, const ec_wnaf_table &p, const mpz_class &v, const ec_wnaf_table &q) {
+    return mul_add_any(u, p, v, q);
+}
+
+ec_jacobian mul_add_jacobian(const mpz_class &u, const ec_wnaf_table &p, const mpz_class &v, const ec_point &q) {
+    return mul_add_any(u, p, v, q);
+}
+
+ec_point mul_add(const mpz_class &u, const ec_wnaf_table &p, const mpz_class &v, const ec_wnaf_table &q) {
+    return p.point().to_affine(mul_add_any(u, p, v, q));
+}
+
+ec_point mul_add(const mpz_class &u, const ec_wnaf_table &p, const mpz_class &v, const ec_point &q) {
+    return p.point().to_affine(mul_add_any(u, p, v, q));
+}
+
+ec_point mul_add(const mpz_class &u, const ec_point &p, const mpz_class &v, const ec_point &q) {
+    return p.to_affine(mul_add_any(u, p, v, q));
+}
+
+// Signed odd digits (Joye-Tunstall) of an odd scalar k: d_i = ((k >> (w * i)) mod 2^(w + 1) | 1) - 2^w for the
+// lower windows, and (k >> (w * (windows - 1))) | 1 for the top one, so that k = sum d_i * 2^(w * i).
+static int odd_digit(const mpz_class &k, const size_t i, const unsigned w, const size_t windows) {
+    if (i == windows - 1)
+        return static_cast<int>(get_bits(k, w * i, w) | 1);
+    return static_cast<int>(get_bits(k, w * i, w + 1) | 1) - (1 << w);
+}
+
+// Loads entry |d| >> 1 of a table of stored affine points into r in constant time, negated if d < 0.
+// scratch holds 3 * c.limbs() limbs.
+template<class Curve>
+static void select_odd_multiple(
+        const Curve &c, typename Curve::affine &r, const mp_limb_t *table, const size_t entries, const int d,
+        mp_limb_t *scratch
+) {
+    const size_t n = c.limbs();
+    const unsigned negative = static_cast<unsigned>(d) >> (sizeof(int) * 8 - 1);
+    const unsigned index = ((static_cast<unsigned>(d) ^ -negative) + negative) >> 1;
+    mp_limb_t *y = scratch + n, *neg_y = scratch + 2 * n;
+    mpn_sec_tabselect(scratch, table, static_cast<mp_size_t>(2 * n), entries, index);
+    // p - y negates in either representation.
+    mpn_sub_n(neg_y, c.modulus_limbs(), y, static_cast<mp_size_t>(n));
+    mpn_cnd_swap(negative, y, neg_y, static_cast<mp_size_t>(n));
+    c.load(r, scratch);
+}
+
+ec_point ec_point::mul_secret(const mpz_class &k, const size_t bits) const {
+    constexpr unsigned w = 4;
+    constexpr size_t table_size = size_t{1} << (w - 1); // P, 3P, ..., (2^w - 1)P
+    assert(k >= 0 && mpz_sizeinbase(k.get_mpz_t(), 2) <= bits);
+    if (is_identity())
+        return *this;
+
+    // Recode the odd scalar k + even; the extra P is subtracted at the end.
+    const size_t windows = bits / w + 1;
+    const mp_limb_t even = 1 - (mpz_getlimbn(k.get_mpz_t(), 0) & 1);
+    const mpz_class odd_k = k + even;
+    return with_curve(*this, [&](const auto &c) {
+        const size_t n = c.limbs();
+        const auto base = c.import(*this);
+        const auto odd = odd_multiples(c, base, table_size);
+        std::vector<mp_limb_t> table(table_size * 2 * n), scratch(3 * n);
+        for (size_t i = 0; i < table_size; ++i)
+            c.store(&table[2 * i * n], odd[i]);
+
+        auto addend = base;
+        select_odd_multiple(c, addend, table.data(), table_size, odd_digit(odd_k, windows - 1, w, windows),
+                            scratch.data());
+        auto acc = c.lift(addend);
+        for (size_t i = windows - 1; i-- > 0;) {
+            for (unsigned j = 0; j < w; ++j)
+                c.dbl(acc);
+            select_odd_multiple(c, addend, table.data(), table_size, odd_digit(odd_k, i, w, windows), scratch.data());
+            c.add(acc, addend);
+        }
+
+        auto fixed = acc;
+        c.add(fixed, c.neg(base));
+        c.cnd_assign(acc, fixed, even);
+        return c.to_point(acc);
+    });
+}
+
+// ec_fixed_base
+
+ec_fixed_base::ec_fixed_base(const ec_point &p, const size_t bits)
+    : p{p}
+    , windows{bits / window + 1}
+    , n{mpz_size(p.modulus().get_mpz_t())} {
+    table = with_curve(p, [&](const auto &c) {
+        // Window i holds (2j + 1) * 2^(window * i) * P for j < entries.
+        std::vector<typename std::decay_t<decltype(c)>::jacobian> t(windows * entries, c.identity());
+        auto base = c.lift(c.import(p));
+        for (size_t i = 0; i < windows; ++i) {
+            auto base2 = base;
+            c.dbl(base2);
+            t[i * entries] = base;
+            for (size_t j = 1; j < entries; ++j) {
+                t[i * entries + j] = t[i * entries + j - 1];
+                c.add(t[i * entries + j], base2);
+            }
+            for (unsigned j = 0; j < window; ++j)
+                c.dbl(base);
+        }
+        const auto affine = c.normalize(t);
+        std::vector<mp_limb_t> r(affine.size() * 2 * n);
+        for (size_t i = 0; i < affine.size(); ++i)
+            c.store(&r[2 * i * n], affine[i]);
+        return r;
+    });
+}
+
+template<class Finish>
+auto ec_fixed_base::multiply(const mpz_class &k, Finish &&finish) const {
+    assert(k >= 0 && mpz_sizeinbase(k.get_mpz_t(), 2) < windows * window);
+
+    // Same recoding as mul_secret(), but every window has its own table, so no doublings are needed.
+    const mp_limb_t even = 1 - (mpz_getlimbn(k.get_mpz_t(), 0) & 1);
+    const mpz_class odd_k = k + even;
+    return with_curve(p, [&](const auto &c) {
+        std::vector<mp_limb_t> scratch(3 * n);
+        const auto base = c.import(p);
+        auto addend = base;
+        const auto select = [&](const size_t i) {
+            select_odd_multiple(c, addend, &table[i * entries * 2 * n], entries, odd_digit(odd_k, i, window, windows),
+                                scratch.data());
+        };
+        select(windows - 1);
+        auto acc = c.lift(addend);
+        for (size_t i = windows - 1; i-- > 0;) {
+            select(i);
+            c.add(acc, addend);
+        }
+
+        auto fixed = acc;
+        c.add(fixed, c.neg(base));
+        c.cnd_assign(acc, fixed, even);
+        return finish(c, acc);
+    });
+}
+
+ec_point ec_fixed_base::operator()(const mpz_class &k) const {
+    if (p.is_identity())
+        return p;
+    return multiply(k, [](const auto &c, const auto &acc) { return c.to_point(acc); });
+}
+
+ec_jacobian ec_fixed_base::jacobian(const mpz_class &k) const {
+    if (p.is_identity())
+        return {1, 1, 0};
+    return multiply(k, [](const auto &c, const auto &acc) { return c.to_mpz(acc); });
+}
+
 std::ostream &operator<<(std::ostream &os, const ec_point &r) {
     os << "(" << r.x << ", " << r.y << ")";
     return os;
 }
+
+ec_keypair::ec_keypair(const ec_point &G, const mpz_class &n)
+    : d{1 + random_below(n - 1)}
+    , Q{G.mul_secret(d, mpz_sizeinbase(n.get_mpz_t(), 2))} {}
@@ -0,0 +1,89 @@
+//
+// Created by wtchr on 10/19/2026.
+//
+
+#include "tls/ec_curves.h"
+
+#include <array>
+#include "tls/fe256.h"
+#include "tls/mpz.h"
+
+// Curve parameters, least significant limb first (SEC 2 and FIPS 186-4).
+
+namespace {
+
+template<size_t N>
+using limbs = std::array<mp_limb_t, N>;
+
+constexpr limbs<4> p256_b = {0x3bce3c3e27d2604b, 0x651d06b0cc53b0f6, 0xb3ebbd55769886bc, 0x5ac635d8aa3a93e7};
+constexpr limbs<4> p256_gx = {0xf4a13945d898c296, 0x77037d812deb33a0, 0xf8bce6e563a440f2, 0x6b17d1f2e12c4247};
+constexpr limbs<4> p256_gy = {0xcbb6406837bf51f5, 0x2bce33576b315ece, 0x8ee7eb4a7c0f9e16, 0x4fe342e2fe1a7f9b};
+constexpr limbs<4> p256_n = {0xf3b9cac2fc632551, 0xbce6faada7179e84, 0xffffffffffffffff, 0xffffffff00000000};
+
+constexpr limbs<6> p384_p = {
+        0x00000000ffffffff, 0xffffffff00000000, 0xfffffffffffffffe,
+        0xffffffffffffffff, 0xffffffffffffffff, 0xffffffffffffffff,
+};
+constexpr limbs<6> p384_b = {
+        0x2a85c8edd3ec2aef, 0xc656398d8a2ed19d, 0x0314088f5013875a,
+        0x181d9c6efe814112, 0x988e056be3f82d19, 0xb3312fa7e23ee7e4,
+};
+constexpr limbs<6> p384_gx = {
+        0x3a545e3872760ab7, 0x5502f25dbf55296c, 0x59f741e082542a38,
+        0x6e1d3b628ba79b98, 0x8eb1c71ef320ad74, 0xaa87ca22be8b0537,
+};
+constexpr limbs<6> p384_gy = {
+        0x7a431d7c90ea0e5f, 0x0a60b1ce1d7e819d, 0xe9da3113b5f0b8c0,
+        0xf8f41dbd289a147c, 0x5d9e98bf9292dc29, 0x3617de4a96262c6f,
+};
+constexpr limbs<6> p384_n = {
+        0xecec196accc52973, 0x581a0db248b0a77a, 0xc7634d81f4372ddf,
+        0xffffffffffffffff, 0xffffffffffffffff, 0xffffffffffffffff,
+};
+
+constexpr limbs<4> secp256k1_gx = {0x59f2815b16f81798, 0x029bfcdb2dce28d9, 0x55a06295ce870b07, 0x79be667ef9dcbbac};
+constexpr limbs<4> secp256k1_gy = {0x9c47d08ffb10d4b8, 0xfd17b448a6855419, 0x5da4fbfc0e1108a8, 0x483ada7726a3c465};
+constexpr limbs<4> secp256k1_n = {0xbfd25e8cd0364141, 0xbaaedce6af48a03b, 0xfffffffffffffffe, 0xffffffffffffffff};
+
+// Builds a curve with a = -3 (NIST curves) or a = 0.
+named_curve make_curve(const char *name, const bool a_is_minus_3, const mpz_class &b, const mpz_class &p,
+                       const mpz_class &gx, const mpz_class &gy, mpz_class n) {
+    const ec_field field{a_is_minus_3 ? mpz_class{p - 3} : mpz_class{0}, b, p};
+    return {name, field, ec_point{gx, gy, field}, std::move(n)};
+}
+
+} // namespace
+
+const named_curve &named_curve::p256() {
+    static const named_curve curve = make_curve(
+            "P-256", true, limbs2mpz(p256_b), limbs2mpz(p256_field::p), limbs2mpz(p256_gx), limbs2mpz(p256_gy),
+            limbs2mpz(p256_n)
+    );
+    return curve;
+}
+
+const named_curve &named_curve::p384() {
+    static const named_curve curve = make_curve(
+            "P-384", true, limbs2mpz(p384_b), limbs2mpz(p384_p), limbs2mpz(p384_gx), limbs2mpz(p384_gy),
+            limbs2mpz(p384_n)
+    );
+    return curve;
+}
+
+const named_curve &named_curve::secp256k1() {
+    static const named_curve curve = make_curve(
+            "secp256k1", false, 7, limbs2mpz(secp256k1_field::p), limbs2mpz(secp256k1_gx), limbs2mpz(secp256k1_gy),
+            limbs2mpz(secp256k1_n)
+    );
+    return curve;
+}
+
+const named_curve *named_curve::find(const std::string_view name) {
+    if (name == "P-256" || name == "secp256r1")
+        return &p256();
+    if (name == "P-384" || name == "secp384r1")
+        return &p384();
+    if (name == "secp256k1")
+        return &secp256k1();
+    return nullptr;
+}
@@ -7,13 +7,19 @@
 #include <cassert>
 #include <vector>
 #include "tls/mpz.h"
+#include "tls/random.h"
 
 ecdsa_class::ecdsa_class(const ec_point &G, mpz_class n)
-    : ec_point{G} {
+    : ec_point{G}
+    , g_table{G, mpz_sizeinbase(n.get_mpz_t(), 2)}
+    , g_wnaf{G, 8} {
     this->n = n;
     this->n_bit = mpz_sizeinbase(n.get_mpz_t(), 2);
 }
 
+ecdsa_class::ecdsa_class(const named_curve &curve)
+    : ecdsa_class{curve.G, curve.n} {}
+
 mpz_class ecdsa_class::mod_inv(const mpz_class &z) const {
     mpz_class r;
     mpz_invert(r.get_mpz_t(), z.get_mpz_t(), n.get_mpz_t());
@@ -21,21 +27,70 @@ mpz_class ecdsa_class::mod_inv(const mpz_class &z) const {
 }
 
 std::pair<mpz_class, mpz_class> ecdsa_class::sign(const mpz_class &m, const mpz_class &d) const {
-    // Discard last bits if m is too big
-    const size_t m_bit = mpz_sizeinbase(m.get_mpz_t(), 2);
-    const mpz_class z = m >> std::max(static_cast<int>(m_bit - n_bit), 0);
+    const mpz_class z = truncate(m);
+
+    std::pair<mpz_class, mpz_class> sig;
+    while (!sign_with(z, d, random_below(n - 1) + 1, sig)) {}
+    return sig;
+}
 
-    mpz_class k, s, r;
-    ec_point P = *this;
+std::pair<mpz_class, mpz_class> ecdsa_class::sign(
+        const mpz_class &m, const mpz_class &d, const presignature &pre
+) const {
+    std::pair<mpz_class, mpz_class> sig;
+    if (!sign_with(truncate(m), d, pre, sig))
+        return sign(m, d);
+    return sig;
+}
+
+ecdsa_class::presignature ecdsa_class::presign() const {
+    presignature pre;
+    mpz_class k;
     do {
-        do {
-            k = random_prime(31);
-            P = k * *this; // k * G
-            r = P.x % n;
-        } while (r == 0);
-        s = mod_inv(k) * (z + r * d) % n;
-    } while (s == 0);
-    return {r, s};
+        k = random_below(n - 1) + 1;
+        pre.r = g_table(k).x % n; // (k * G).x
+    } while (pre.r == 0);
+    pre.k_inv = mod_inv(k);
+    return pre;
+}
+
+std::vector<ecdsa_class::presignature> ecdsa_class::presign(const size_t count) const {
+    std::vector<mpz_class> k(count);
+    std::vector<ec_jacobian> R;
+    R.reserve(count);
+    for (auto &ki : k) {
+        ki = random_below(n - 1) + 1;
+        R.push_back(g_table.jacobian(ki));
+    }
+    const auto affine = to_affine(R);
+    const auto k_inv = batch_inverse(k);
+
+    std::vector<presignature> pre;
+    pre.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        mpz_class r = affine[i].x % n;
+        if (r != 0)
+            pre.push_back({k_inv[i], std::move(r)});
+    }
+    return pre;
+}
+
+bool ecdsa_class::sign_with(
+        const mpz_class &z, const mpz_class &d, const mpz_class &k, std::pair<mpz_class, mpz_class> &sig
+) const {
+    const mpz_class r = g_table(k).x % n; // (k * G).x
+    if (r == 0)
+        return false;
+    return sign_with(z, d, presignature{mod_inv(k), r}, sig);
+}
+
+bool ecdsa_class::sign_with(
+        const mpz_class &z, const mpz_class &d, const presignature &pre, std::pair<mpz_class, mpz_class> &sig
+) const {
+    auto &[r, s] = sig;
+    r = pre.r;
+    s = pre.k_inv * (z + r * d) % n;
+    return s != 0;
 }
 
 bool ecdsa_class::verify(const mpz_class &m, const std::pair<mpz_class, mpz_class> &sig, const ec_point &Q) const {
@@ -45,17 +100,104 @@ bool ecdsa_class::verify(const mpz_class &m, const std::pair<mpz_class, mpz_clas
     if (s < 1 || s >= n)
         return false;
 
-    // Discard last bits if m is too big
-    const size_t m_bit = mpz_sizeinbase(m.get_mpz_t(), 2);
-    const mpz_class z = m >> std::max(static_cast<int>(m_bit - n_bit), 0);
+    const mpz_class z = truncate(m);
 
     const mpz_class inv_s = mod_inv(s);
     const mpz_class u = z * inv_s % n;
     const mpz_class v = r * inv_s % n;
-    const ec_point P = u * *this + v * Q;
+    const ec_point P = mul_add(u, g_wnaf, v, Q); // u * G + v * Q
     if (P.is_identity())
         return false;
     if ((P.x - r) % n == 0)
         return true;
     return false;
 }
+
+std::pair<mpz_class, mpz_class> ecdsa_class::sign(const std::span<const unsigned char> digest, const mpz_class &d) const {
+    return sign(bits2int(digest), d);
+}
+
+bool ecdsa_class::verify(
+        const std::span<const unsigned char> digest, const std::pair<mpz_class, mpz_class> &sig, const ec_point &Q
+) const {
+    return verify(bits2int(digest), sig, Q);
+}
+
+std::vector<bool> ecdsa_class::verify_batch(const std::span<const signed_message> batch) const {
+    std::vector<bool> valid(batch.size(), false);
+    std::vector<size_t> index; // Entries whose r and s are in range
+    for (size_t i = 0; i < batch.size(); ++i) {
+        const auto &[r, s] = batch[i].sig;
+        if (r >= 1 && r < n && s >= 1 && s < n)
+            index.push_back(i);
+    }
+    if (index.empty())
+        return valid;
+
+    std::vector<mpz_class> s(index.size());
+    for (size_t j = 0; j < index.size(); ++j)
+        s[j] = batch[index[j]].sig.second;
+    const auto inv_s = batch_inverse(s);
+
+    std::vector<ec_jacobian> points;
+    points.reserve(index.size());
+    for (size_t j = 0; j < index.size(); ++j) {
+        const auto &[m, sig, Q] = batch[index[j]];
+        const mpz_class u = truncate(m) * inv_s[j] % n;
+        const mpz_class v = sig.first * inv_s[j] % n;
+        points.push_back(mul_add_jacobian(u, g_wnaf, v, Q));
+    }
+    const auto affine = to_affine(points);
+    for (size_t j = 0; j < index.size(); ++j)
+        valid[index[j]] = !affine[j].is_identity() && (affine[j].x - batch[index[j]].sig.first) % n == 0;
+    return valid;
+}
+
+std::vector<mpz_class> ecdsa_class::batch_inverse(const std::span<const mpz_class> a) const {
+    // Montgomery's trick: prefix[j] = a_0 * ... * a_j, so one inversion yields every a_j^-1.
+    std::vector<mpz_class> prefix(a.size()), inv(a.size());
+    mpz_class acc = 1;
+    for (size_t j = 0; j < a.size(); ++j) {
+        acc = acc * a[j] % n;
+        prefix[j] = acc;
+    }
+    acc = mod_inv(acc);
+    for (size_t j = a.size(); j-- > 0;) {
+        inv[j] = j > 0 ? acc * prefix[j - 1] % n : acc;
+        acc = acc * a[j] % n;
+    }
+    return inv;
+}
+
+mpz_class ecdsa_class::truncate(const mpz_class &m) const {
+    // Discard last bits if m is too big
+    const size_t m_bit = mpz_sizeinbase(m.get_mpz_t(), 2);
+    return m >> std::max(static_cast<int>(m_bit - n_bit), 0);
+}
+
+mpz_class ecdsa_class::bits2int(const std::span<const unsigned char> digest) const {
+    // Import only the bytes that can contribute to the leftmost n_bit bits.
+    const size_t len = std::min(digest.size(), (n_bit + 7) / 8);
+    mpz_class z = bnd2mpz(digest.first(len));
+    if (len * 8 > n_bit)
+        z >>= len * 8 - n_bit;
+    return z;
+}
+
+// ecdsa_presign_pool
+
+ecdsa_presign_pool::ecdsa_presign_pool(
+        const ecdsa_class &ecdsa, const size_t low_watermark, const size_t high_watermark, const unsigned threads,
+        const size_t batch
+)
+    : ecdsa{ecdsa}
+    , pool{[&ecdsa] { return ecdsa.presign(); }, [&ecdsa, batch] { return ecdsa.presign(batch); }, low_watermark,
+           high_watermark, threads} {}
+
+std::pair<mpz_class, mpz_class> ecdsa_presign_pool::sign(const mpz_class &m, const mpz_class &d) {
+    return ecdsa.sign(m, d, pool.take());
+}
+
+keypair_pool<ecdsa_class::presignature>::statistics ecdsa_presign_pool::stats() const {
+    return pool.stats();
+}
@@ -0,0 +1,423 @@
+//
+// Created by wtchr on 10/19/2026.
+//
+
+#include "tls/ed25519.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <gmpxx.h>
+#include <initializer_list>
+#include "tls/fe25519.h"
+#include "tls/mpz.h"
+#include "tls/random.h"
+#include "tls/sha/sha2.h"
+
+namespace {
+
+// Extended coordinates: x = X / Z, y = Y / Z, x * y = T / Z.
+struct ed_point {
+    fe25519 X, Y, Z, T;
+};
+
+// Affine point prepared for mixed addition: (y + x, y - x, 2 * d * x * y).
+struct ed_niels {
+    fe25519 yplusx, yminusx, xy2d;
+};
+
+// Point prepared for addition: (Y + X, Y - X, Z, 2 * d * T).
+struct ed_cached {
+    fe25519 YplusX, YminusX, Z, T2d;
+};
+
+constexpr fe25519 d{{0x34dca135978a3, 0x1a8283b156ebd, 0x5e7a26001c029, 0x739c663a03cbb, 0x52036cee2b6ff}};
+constexpr fe25519 d2{{0x69b9426b2f159, 0x35050762add7a, 0x3cf44c0038052, 0x6738cc7407977, 0x2406d9dc56dff}};
+constexpr fe25519 sqrt_m1{{0x61b274a0ea0b0, 0xd5a5fc8f189d, 0x7ef5e9cbd0c60, 0x78595a6804c9e, 0x2b8324804fc1d}};
+
+// The base point B = (x, 4/5).
+constexpr fe25519 base_x{{0x62d608f25d51a, 0x412a4b4f6592a, 0x75b7171a4b31d, 0x1ff60527118fe, 0x216936d3cd6e5}};
+constexpr fe25519 base_y{{0x6666666666658, 0x4cccccccccccc, 0x1999999999999, 0x3333333333333, 0x6666666666666}};
+
+ed_point identity() {
+    return {fe25519{}, fe25519::one(), fe25519::one(), fe25519{}};
+}
+
+ed_point base_point() {
+    return {base_x, base_y, fe25519::one(), base_x * base_y};
+}
+
+bool is_identity(const ed_point &p) {
+    return p.X.is_zero() && (p.Y - p.Z).is_zero();
+}
+
+ed_point neg(const ed_point &p) {
+    return {-p.X, p.Y, p.Z, -p.T};
+}
+
+ed_cached to_cached(const ed_point &p) {
+    return {p.Y + p.X, p.Y - p.X, p.Z, p.T * d2};
+}
+
+ed_cached neg(const ed_cached &p) {
+    return {p.YminusX, p.YplusX, p.Z, -p.T2d};
+}
+
+ed_niels neg(const ed_niels &p) {
+    return {p.yminusx, p.yplusx, -p.xy2d};
+}
+
+// dbl-2008-hwcd with a = -1.
+void dbl(ed_point &p) {
+    const fe25519 a = p.X.sqr(), b = p.Y.sqr(), zz = p.Z.sqr(), c = zz + zz;
+    const fe25519 e = (p.X + p.Y).sqr() - a - b, g = b - a, f = g - c, h = fe25519{} - a - b;
+    p.X = e * f;
+    p.Y = g * h;
+    p.T = e * h;
+    p.Z = f * g;
+}
+
+// add-2008-hwcd-3 with a = -1; complete, since d is not a square.
+void add(ed_point &p, const ed_cached &q) {
+    const fe25519 a = (p.Y - p.X) * q.YminusX, b = (p.Y + p.X) * q.YplusX, c = p.T * q.T2d, zz = p.Z * q.Z;
+    const fe25519 dd = zz + zz, e = b - a, f = dd - c, g = dd + c, h = b + a;
+    p.X = e * f;
+    p.Y = g * h;
+    p.T = e * h;
+    p.Z = f * g;
+}
+
+// Mixed addition (Z2 = 1).
+void add(ed_point &p, const ed_niels &q) {
+    const fe25519 a = (p.Y - p.X) * q.yminusx, b = (p.Y + p.X) * q.yplusx, c = p.T * q.xy2d;
+    const fe25519 dd = p.Z + p.Z, e = b - a, f = dd - c, g = dd + c, h = b + a;
+    p.X = e * f;
+    p.Y = g * h;
+    p.T = e * h;
+    p.Z = f * g;
+}
+
+// Converts points to affine niels form with a single inversion (Montgomery's trick).
+std::vector<ed_niels> to_niels(const std::vector<ed_point> &p) {
+    std::vector<fe25519> prefix(p.size());
+    fe25519 acc = fe25519::one();
+    for (size_t i = 0; i < p.size(); ++i) {
+        acc = acc * p[i].Z;
+        prefix[i] = acc;
+    }
+    fe25519 inv = acc.inv();
+    std::vector<ed_niels> r(p.size());
+    for (size_t i = p.size(); i-- > 0;) {
+        const fe25519 zi = i > 0 ? inv * prefix[i - 1] : inv;
+        inv = inv * p[i].Z;
+        const fe25519 x = p[i].X * zi, y = p[i].Y * zi;
+        r[i] = {y + x, y - x, x * y * d2};
+    }
+    return r;
+}
+
+void encode(const ed_point &p, unsigned char *out) {
+    const fe25519 zi = p.Z.inv(), x = p.X * zi, y = p.Y * zi;
+    y.to_bytes(out);
+    out[31] |= static_cast<unsigned char>(x.is_negative() << 7);
+}
+
+// Decodes a point (RFC 8032, section 5.1.3); fails on non-canonical y, on y with no x, and on a negative x = 0.
+bool decode(const unsigned char *in, ed_point &p) {
+    const fe25519 y = fe25519::from_bytes(in);
+    unsigned char t[32];
+    y.to_bytes(t);
+    t[31] |= in[31] & 0x80;
+    if (!std::equal(t, t + 32, in))
+        return false;
+
+    // x = u * v^3 * (u * v^7)^((p - 5) / 8) is a square root of u / v, up to a factor sqrt(-1).
+    const fe25519 yy = y.sqr(), u = yy - fe25519::one(), v = yy * d + fe25519::one();
+    const fe25519 v3 = v.sqr() * v, v7 = v3.sqr() * v;
+    fe25519 x = u * v3 * (u * v7).pow22523();
+    const fe25519 vxx = v * x.sqr();
+    if (!(vxx - u).is_zero()) {
+        if (!(vxx + u).is_zero())
+            return false;
+        x = x * sqrt_m1;
+    }
+    const bool sign = in[31] >> 7;
+    if (x.is_zero() && sign)
+        return false;
+    if (x.is_negative() != sign)
+        x = -x;
+    p = {x, y, fe25519::one(), x * y};
+    return true;
+}
+
+// Replaces r by a if bit is set, without branching on bit.
+void cmov(ed_niels &r, ed_niels a, const uint64_t bit) {
+    fe25519::cswap(r.yplusx, a.yplusx, bit);
+    fe25519::cswap(r.yminusx, a.yminusx, bit);
+    fe25519::cswap(r.xy2d, a.xy2d, bit);
+}
+
+// j * 16^i * B for windows i < 64 and j = 1, ..., 8.
+using base_window = std::array<ed_niels, 8>;
+
+const std::vector<base_window> &base_table() {
+    static const std::vector<base_window> table = [] {
+        std::vector<ed_point> t(64 * 8);
+        ed_point base = base_point();
+        for (size_t i = 0; i < 64; ++i) {
+            const ed_cached c = to_cached(base);
+            t[i * 8] = base;
+            for (size_t j = 1; j < 8; ++j) {
+                t[i * 8 + j] = t[i * 8 + j - 1];
+                add(t[i * 8 + j], c);
+            }
+            for (int j = 0; j < 4; ++j)
+                dbl(base);
+        }
+        const auto niels = to_niels(t);
+        std::vector<base_window> r(64);
+        for (size_t i = 0; i < niels.size(); ++i)
+            r[i / 8][i % 8] = niels[i];
+        return r;
+    }();
+    return table;
+}
+
+// Odd multiples B, 3B, ..., 127B for width-8 NAF.
+const std::vector<ed_niels> &base_odd_multiples() {
+    static const std::vector<ed_niels> table = [] {
+        std::vector<ed_point> t(64, base_point());
+        ed_point b2 = base_point();
+        dbl(b2);
+        const ed_cached c = to_cached(b2);
+        for (size_t i = 1; i < t.size(); ++i) {
+            t[i] = t[i - 1];
+            add(t[i], c);
+        }
+        return to_niels(t);
+    }();
+    return table;
+}
+
+// s * B for a scalar below 2^255, in constant time.
+ed_point mul_base(const ed25519::key_type &s) {
+    // Signed radix-16 digits in [-8, 8].
+    int8_t e[64];
+    for (int i = 0; i < 32; ++i) {
+        e[2 * i] = static_cast<int8_t>(s[i] & 15);
+        e[2 * i + 1] = static_cast<int8_t>(s[i] >> 4);
+    }
+    int8_t carry = 0;
+    for (int i = 0; i < 63; ++i) {
+        e[i] = static_cast<int8_t>(e[i] + carry);
+        carry = static_cast<int8_t>((e[i] + 8) >> 4);
+        e[i] = static_cast<int8_t>(e[i] - (carry << 4));
+    }
+    e[63] = static_cast<int8_t>(e[63] + carry);
+
+    const auto &table = base_table();
+    ed_point r = identity();
+    for (size_t i = 0; i < 64; ++i) {
+        const uint64_t negative = static_cast<uint8_t>(e[i]) >> 7;
+        const uint64_t abs = static_cast<uint64_t>(e[i] - ((-static_cast<int>(negative) & e[i]) << 1));
+        ed_niels t{fe25519::one(), fe25519::one(), fe25519{}};
+        for (uint64_t j = 1; j <= 8; ++j)
+            cmov(t, table[i][j - 1], ((abs ^ j) - 1) >> 63);
+        cmov(t, neg(t), negative);
+        add(r, t);
+    }
+    return r;
+}
+
+// Width-w NAF of a 256-bit little-endian scalar, as in src/diffie_hellman.cpp.
+std::array<int8_t, 257> wnaf(const ed25519::key_type &s, const int w) {
+    const auto bit = [&s](const size_t i) { return i < 256 ? s[i / 8] >> (i % 8) & 1 : 0; };
+    std::array<int8_t, 257> naf{};
+    int carry = 0;
+    for (size_t i = 0; i < 256;) {
+        if (bit(i) == carry) {
+            ++i;
+            continue;
+        }
+        int word = carry;
+        for (int j = 0; j < w; ++j)
+            word += bit(i + j) << j;
+        carry = word >> (w - 1) & 1;
+        word -= carry << w;
+        naf[i] = static_cast<int8_t>(word);
+        i += w;
+    }
+    naf[256] = static_cast<int8_t>(carry);
+    return naf;
+}
+
+// sb * B + sum s[i] * p[i] with one shared doubling chain (variable time; public inputs only).
+ed_point mul_add(const ed25519::key_type &sb, const std::vector<ed25519::key_type> &s, const std::vector<ed_point> &p) {
+    constexpr int w = 5;
+    const auto naf_b = wnaf(sb, 8);
+    std::vector<std::array<int8_t, 257>> naf;
+    std::vector<std::array<ed_cached, 8>> table(p.size());
+    naf.reserve(p.size());
+    for (size_t i = 0; i < p.size(); ++i) {
+        naf.push_back(wnaf(s[i], w));
+        ed_point q = p[i], q2 = p[i];
+        dbl(q2);
+        const ed_cached c = to_cached(q2);
+        table[i][0] = to_cached(q);
+        for (size_t j = 1; j < table[i].size(); ++j) {
+            add(q, c);
+            table[i][j] = to_cached(q);
+        }
+    }
+
+    const auto &b_table = base_odd_multiples();
+    ed_point r = identity();
+    bool started = false;
+    for (size_t i = 257; i-- > 0;) {
+        if (started)
+            dbl(r);
+        if (const int digit = naf_b[i]) {
+            add(r, digit > 0 ? b_table[digit >> 1] : neg(b_table[-digit >> 1]));
+            started = true;
+        }
+        for (size_t j = 0; j < p.size(); ++j) {
+            if (const int digit = naf[j][i]) {
+                add(r, digit > 0 ? table[j][digit >> 1] : neg(table[j][-digit >> 1]));
+                started = true;
+            }
+        }
+    }
+    return r;
+}
+
+// Scalars modulo the group order L = 2^252 + 27742317777372353535851937790883648493.
+
+constexpr std::array<mp_limb_t, 4> order_limbs = {0x5812631a5cf5d3ed, 0x14def9dea2f79cd6, 0, 0x1000000000000000};
+
+const mpz_class &order() {
+    static const mpz_class L = limbs2mpz(order_limbs);
+    return L;
+}
+
+mpz_class load_scalar(const unsigned char *in, const size_t size) {
+    mpz_class r;
+    mpz_import(r.get_mpz_t(), size, -1, 1, 0, 0, in);
+    return r;
+}
+
+ed25519::key_type store_scalar(const mpz_class &s) {
+    ed25519::key_type r{};
+    mpz_export(r.data(), nullptr, -1, 1, 0, 0, s.get_mpz_t());
+    return r;
+}
+
+// SHA-512 of the concatenated parts, reduced modulo L.
+mpz_class hash_scalar(std::initializer_list<std::span<const unsigned char>> parts) {
+    sha512 h;
+    for (const auto &part : parts)
+        h.update(part.begin(), part.end());
+    const auto digest = h.digest();
+    mpz_class r = load_scalar(digest.data(), digest.size());
+    mpz_mod(r.get_mpz_t(), r.get_mpz_t(), order().get_mpz_t());
+    return r;
+}
+
+// The decoded inputs of one verification, or false if any is malformed.
+bool prepare(const std::span<const unsigned char> message, const std::span<const unsigned char, 64> sig,
+             const std::span<const unsigned char, 32> public_key, ed_point &A, ed_point &R, mpz_class &S,
+             mpz_class &k) {
+    S = load_scalar(sig.data() + 32, 32);
+    if (S >= order() || !decode(public_key.data(), A) || !decode(sig.data(), R))
+        return false;
+    k = hash_scalar({sig.first<32>(), public_key, message});
+    return true;
+}
+
+// Multiplies by the cofactor 8 and checks for the identity.
+bool is_small_order(ed_point p) {
+    for (int i = 0; i < 3; ++i)
+        dbl(p);
+    return is_identity(p);
+}
+
+} // namespace
+
+ed25519::ed25519()
+    : ed25519{[] {
+        key_type k;
+        random_bytes(k);
+        return k;
+    }()} {}
+
+ed25519::ed25519(const std::span<const unsigned char, key_size> private_key) {
+    sha512 h;
+    const auto digest = h.hash(private_key.begin(), private_key.end());
+    std::copy_n(digest.begin(), key_size, a.begin());
+    std::copy_n(digest.begin() + key_size, key_size, prefix.begin());
+    a[0] &= 248;
+    a[31] &= 127;
+    a[31] |= 64;
+    encode(mul_base(a), A.data());
+}
+
+const ed25519::key_type &ed25519::public_key() const {
+    return A;
+}
+
+ed25519::signature_type ed25519::sign(const std::span<const unsigned char> message) const {
+    signature_type sig;
+    const mpz_class r = hash_scalar({prefix, message});
+    encode(mul_base(store_scalar(r)), sig.data());
+    const mpz_class k = hash_scalar({std::span{sig}.first<32>(), A, message});
+    const mpz_class s = (r + k * load_scalar(a.data(), a.size())) % order();
+    const auto s_bytes = store_scalar(s);
+    std::copy(s_bytes.begin(), s_bytes.end(), sig.begin() + 32);
+    return sig;
+}
+
+bool ed25519::verify(const std::span<const unsigned char> message, const std::span<const unsigned char, signature_size> sig,
+                     const std::span<const unsigned char, key_size> public_key) {
+    ed_point A, R;
+    mpz_class S, k;
+    if (!prepare(message, sig, public_key, A, R, S, k))
+        return false;
+    // [S]B - [k]A - R
+    ed_point P = mul_add(store_scalar(S), {store_scalar(k)}, {neg(A)});
+    add(P, to_cached(neg(R)));
+    return is_small_order(P);
+}
+
+std::vector<bool> ed25519::verify_batch(const std::span<const signed_message> batch) {
+    std::vector<bool> result(batch.size(), false);
+    std::vector<size_t> index;
+    std::vector<key_type> scalars;
+    std::vector<ed_point> points;
+    mpz_class sb = 0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        ed_point A, R;
+        mpz_class S, k;
+        if (!prepare(batch[i].message, batch[i].sig, batch[i].public_key, A, R, S, k))
+            continue;
+        unsigned char z_bytes[16];
+        random_bytes(z_bytes);
+        const mpz_class z = load_scalar(z_bytes, sizeof z_bytes);
+        scalars.push_back(store_scalar(z));
+        points.push_back(R);
+        scalars.push_back(store_scalar(z * k % order()));
+        points.push_back(A);
+        sb -= z * S;
+        index.push_back(i);
+    }
+    if (index.empty())
+        return result;
+
+    // (-sum z_i S_i) B + sum z_i R_i + sum (z_i k_i) A_i
+    mpz_mod(sb.get_mpz_t(), sb.get_mpz_t(), order().get_mpz_t());
+    if (is_small_order(mul_add(store_scalar(sb), scalars, points))) {
+        for (const size_t i : index)
+            result[i] = true;
+    } else {
+        for (const size_t i : index)
+            result[i] = verify(batch[i].message, batch[i].sig, batch[i].public_key);
+    }
+    return result;
+}
@@ -4,10 +4,88 @@
 
 #include "tls/mpz.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
-#include <iomanip>
-#include <random>
+#include <mutex>
+#include <thread>
 #include <vector>
+#include "tls/random.h"
+
+namespace {
+    constexpr unsigned sieve_limit = 1 << 16; ///< Candidates are sieved with the odd primes below this bound.
+    constexpr unsigned sieve_window = 1 << 12; ///< Number of odd candidates sieved at once.
+    constexpr int prime_test_reps = 30; ///< BPSW followed by a few extra Miller-Rabin rounds
+
+    const std::vector<unsigned> &small_primes() {
+        static const std::vector<unsigned> primes = [] {
+            std::vector<bool> composite(sieve_limit);
+            std::vector<unsigned> v;
+            for (unsigned i = 3; i < sieve_limit; i += 2) {
+                if (composite[i])
+                    continue;
+                v.push_back(i);
+                for (unsigned j = i * i; j < sieve_limit; j += 2 * i)
+                    composite[j] = true;
+            }
+            return v;
+        }();
+        return primes;
+    }
+
+    /**
+     * @brief Searches for a prime of the given bit length from random starting points until one is found here or
+     * by another thread.
+     * @param bits The bit length of the prime (larger than the sieve bound).
+     * @param found Set by whichever thread finds a prime first.
+     * @param[out] out The prime, if this thread found one.
+     * @return True if this thread found a prime.
+     */
+    bool sieve_search(const size_t bits, const std::atomic<bool> &found, mpz_class &out) {
+        const auto &primes = small_primes();
+        std::vector<unsigned> residues(primes.size());
+        std::vector<unsigned char> composite(sieve_window);
+        mpz_class base, c;
+        while (!found.load(std::memory_order_relaxed)) {
+            // Random odd starting point with the two top bits set.
+            base = random_bits(bits);
+            mpz_setbit(base.get_mpz_t(), bits - 1);
+            mpz_setbit(base.get_mpz_t(), bits - 2);
+            mpz_setbit(base.get_mpz_t(), 0);
+            for (size_t i = 0; i < primes.size(); ++i)
+                residues[i] = mpz_fdiv_ui(base.get_mpz_t(), primes[i]);
+
+            // Walk windows of base, base + 2, base + 4, ... updating the residues incrementally.
+            for (bool overflow = false; !overflow && !found.load(std::memory_order_relaxed);) {
+                std::fill(composite.begin(), composite.end(), 0);
+                for (size_t i = 0; i < primes.size(); ++i) {
+                    const unsigned long p = primes[i], r = residues[i];
+                    // base + 2j is divisible by p when j = -r / 2 (mod p).
+                    for (unsigned long j = (p - r) % p * ((p + 1) / 2) % p; j < sieve_window; j += p)
+                        composite[j] = 1;
+                    residues[i] = (r + 2 * sieve_window) % p;
+                }
+                for (unsigned j = 0; j < sieve_window; ++j) {
+                    if (composite[j])
+                        continue;
+                    c = base + 2 * j;
+                    if (mpz_sizeinbase(c.get_mpz_t(), 2) > bits) {
+                        overflow = true;
+                        break;
+                    }
+                    if (mpz_probab_prime_p(c.get_mpz_t(), prime_test_reps)) {
+                        out = c;
+                        return true;
+                    }
+                    if (found.load(std::memory_order_relaxed))
+                        return false;
+                }
+                base += 2 * sieve_window;
+            }
+        }
+        return false;
+    }
+} // namespace
 
 mpz_class nextprime(const mpz_class &n) {
     mpz_class r;
@@ -22,17 +100,240 @@ mpz_class powm(const mpz_class &base, const mpz_class &exp, const mpz_class &mod
     return r;
 }
 
+void mpz2bnd(const mpz_class &n, std::span<unsigned char> out) {
+    const mpz_srcptr z = n.get_mpz_t();
+    assert(mpz_sgn(z) >= 0);
+    const size_t size = mpz_sgn(z) ? (mpz_sizeinbase(z, 2) + 7) / 8 : 0;
+    if (size <= out.size()) {
+        std::fill(out.begin(), out.end() - size, 0);
+        if (size)
+            mpz_export(out.data() + out.size() - size, nullptr, 1, 1, 1, 0, z);
+        return;
+    }
+    // Too big: keep only the low-order bytes, read straight from the limbs.
+    for (size_t i = 0; i < out.size(); ++i) {
+        const mp_limb_t limb = mpz_getlimbn(z, static_cast<mp_size_t>(i / sizeof(mp_limb_t)));
+        out[out.size() - 1 - i] = static_cast<unsigned char>(limb >> 8 * (i % sizeof(mp_limb_t)));
+    }
+}
+
+mpz_class bnd2mpz(const std::span<const unsigned char> in) {
+    mpz_class r;
+    mpz_import(r.get_mpz_t(), in.size(), 1, 1, 1, 0, in.data());
+    return r;
+}
+
+mpz_class limbs2mpz(const std::span<const mp_limb_t> limbs) {
+    mpz_t view;
+    return mpz_class{mpz_roinit_n(view, limbs.data(), static_cast<mp_size_t>(limbs.size()))};
+}
+
+fixed_base_powm::fixed_base_powm(
+        const mpz_class &base, const mpz_class &mod, const size_t max_exp_bits, const unsigned window
+)
+    : base{base}
+    , mod{mod}
+    , window{window} {
+    assert(mod != 0 && window > 0 && GMP_NUMB_BITS % window == 0);
+    table.resize((max_exp_bits + window - 1) / window);
+    mpz_class x = base % mod;
+    for (auto &t : table) {
+        t = x;
+        for (unsigned j = 0; j < window; ++j)
+            mpz_powm_ui(x.get_mpz_t(), x.get_mpz_t(), 2, mod.get_mpz_t());
+    }
+}
+
+mpz_class fixed_base_powm::operator()(const mpz_class &exp) const {
+    assert(exp >= 0);
+    if (mpz_sizeinbase(exp.get_mpz_t(), 2) > table.size() * window)
+        return powm(base, exp, mod);
+
+    // Split the exponent into window-sized digits, read straight from the limbs.
+    const size_t n = std::min(table.size(), (mpz_sizeinbase(exp.get_mpz_t(), 2) + window - 1) / window);
+    const mp_limb_t mask = (mp_limb_t{1} << window) - 1;
+    std::vector<unsigned> digits(n);
+    for (size_t i = 0; i < n; ++i) {
+        const size_t bit = i * window;
+        digits[i] = mpz_getlimbn(exp.get_mpz_t(), bit / GMP_NUMB_BITS) >> bit % GMP_NUMB_BITS & mask;
+    }
+
+    // Yao's method: a = prod_d (prod_{i : digit_i = d} table[i])^d, accumulated from the largest digit down.
+    mpz_class a = 1, b = 1;
+    bool b_is_one = true;
+    for (unsigned d = mask; d > 0; --d) {
+        for (size_t i = 0; i < n; ++i) {
+            if (digits[i] != d)
+                continue;
+            if (b_is_one) {
+                b = table[i];
+                b_is_one = false;
+            } else {
+                mpz_mul(b.get_mpz_t(), b.get_mpz_t(), table[i].get_mpz_t());
+                mpz_mod(b.get_mpz_t(), b.get_mpz_t(), mod.get_mpz_t());
+            }
+        }
+        if (!b_is_one) {
+            mpz_mul(a.get_mpz_t(), a.get_mpz_t(), b.get_mpz_t());
+            mpz_mod(a.get_mpz_t(), a.get_mpz_t(), mod.get_mpz_t());
+        }
+    }
+    return a % mod;
+}
+
+montgomery_context::montgomery_context(const mpz_class &mod) : mod{mod} {
+    assert(mod > 1);
+    if (mpz_even_p(mod.get_mpz_t()))
+        return;
+    const size_t n = mpz_size(mod.get_mpz_t());
+    m.assign(mpz_limbs_read(mod.get_mpz_t()), mpz_limbs_read(mod.get_mpz_t()) + n);
+    // Newton iteration for m^-1 mod 2^limb_bits; m * m = 1 mod 8 gives the first 3 bits.
+    mp_limb_t inv = m[0];
+    for (int i = 0; i < 5; ++i)
+        inv *= 2 - m[0] * inv;
+    m_inv = -inv;
+    mpz_class r;
+    mpz_setbit(r.get_mpz_t(), 2 * n * GMP_NUMB_BITS);
+    r %= mod;
+    r2.assign(n, 0);
+    std::copy_n(mpz_limbs_read(r.get_mpz_t()), mpz_size(r.get_mpz_t()), r2.begin());
+}
+
+const mpz_class &montgomery_context::modulus() const {
+    return mod;
+}
+
+void montgomery_context::redc(mp_limb_t *r, mp_limb_t *t) const {
+    const auto n = static_cast<mp_size_t>(m.size());
+    for (mp_size_t i = 0; i < n; ++i) {
+        // Clear limb i by adding a multiple of m; the carry out belongs at limb i + n and is kept in the freed limb.
+        t[i] = mpn_addmul_1(t + i, m.data(), n, t[i] * m_inv);
+    }
+    if (mpn_add_n(r, t + n, t, n) || mpn_cmp(r, m.data(), n) >= 0)
+        mpn_sub_n(r, r, m.data(), n);
+}
+
+void montgomery_context::mul(mp_limb_t *r, const mp_limb_t *a, const mp_limb_t *b, mp_limb_t *t) const {
+    const auto n = static_cast<mp_size_t>(m.size());
+    if (a == b)
+        mpn_sqr(t, a, n);
+    else
+        mpn_mul_n(t, a, b, n);
+    redc(r, t);
+}
+
+mpz_class montgomery_context::powm(const mpz_class &base, const mpz_class &exp) const {
+    if (m.empty() || exp < 0)
+        return ::powm(base, exp, mod);
+    if (exp == 0)
+        return 1;
+    const size_t bits = mpz_sizeinbase(exp.get_mpz_t(), 2);
+
+    const size_t n = m.size();
+    const unsigned w = bits > 671 ? 6 : bits > 239 ? 5 : bits > 79 ? 4 : bits > 23 ? 3 : bits > 1 ? 2 : 1;
+    const size_t table_size = size_t{1} << (w - 1);
+
+    // Layout of the per-thread scratch: table of odd powers, accumulator, base^2, and a double-width product.
+    thread_local std::vector<mp_limb_t> scratch;
+    scratch.resize(std::max(scratch.size(), (table_size + 4) * n));
+    mp_limb_t *table = scratch.data();
+    mp_limb_t *acc = table + table_size * n;
+    mp_limb_t *x2 = acc + n;
+    mp_limb_t *t = x2 + n;
+
+    // table[0] = base * R mod m, table[i] = base^(2i + 1) * R mod m
+    mpz_class reduced;
+    const mpz_class *b = &base;
+    if (base < 0 || base >= mod) {
+        mpz_mod(reduced.get_mpz_t(), base.get_mpz_t(), mod.get_mpz_t());
+        b = &reduced;
+    }
+    std::fill_n(acc, n, 0);
+    std::copy_n(mpz_limbs_read(b->get_mpz_t()), mpz_size(b->get_mpz_t()), acc);
+    mul(table, acc, r2.data(), t);
+    if (table_size > 1) {
+        mul(x2, table, table, t);
+        for (size_t i = 1; i < table_size; ++i)
+            mul(table + i * n, table + (i - 1) * n, x2, t);
+    }
+
+    // Left-to-right sliding window over the exponent bits.
+    const auto bit = [&exp](const size_t i) { return mpz_tstbit(exp.get_mpz_t(), i) != 0; };
+    bool first = true;
+    for (size_t i = bits; i-- > 0;) {
+        if (!bit(i)) {
+            mul(acc, acc, acc, t);
+            continue;
+        }
+        size_t j = i + 1 > w ? i + 1 - w : 0;
+        while (!bit(j))
+            ++j;
+        size_t value = 0;
+        for (size_t k = i + 1; k-- > j;)
+            value = value << 1 | bit(k);
+        if (first) {
+            std::copy_n(table + (value >> 1) * n, n, acc);
+            first = false;
+        } else {
+            for (size_t k = j; k <= i; ++k)
+                mul(acc, acc, acc, t);
+            mul(acc, acc, table + (value >> 1) * n, t);
+        }
+        i = j;
+    }
+
+    // Leave the Montgomery domain: acc * R^-1 mod m.
+    std::copy_n(acc, n, t);
+    std::fill_n(t + n, n, 0);
+    mpz_class r;
+    mp_limb_t *rp = mpz_limbs_write(r.get_mpz_t(), static_cast<mp_size_t>(n));
+    redc(rp, t);
+    mpz_limbs_finish(r.get_mpz_t(), static_cast<mp_size_t>(n));
+    return r;
+}
+
 mpz_class random_prime(const unsigned b) {
     std::vector<unsigned char> arr(b);
     mpz_class z;
     do {
-        std::uniform_int_distribution di{0, 0xff};
-        std::random_device rd;
-        for (int i = 0; i < b; ++i)
-            arr[i] = di(rd);
+        random_bytes(arr);
         z = nextprime(bnd2mpz(arr.begin(), arr.end()));
         std::fill(arr.begin(), arr.end(), 0xff);
         // Retry if z is larger than b bytes
     } while (z > bnd2mpz(arr.begin(), arr.end()));
     return z;
 }
+
+mpz_class generate_prime(const size_t bits, unsigned threads) {
+    assert(bits >= 2);
+    if (bits <= 32) {
+        // Too small to sieve against the table; search directly.
+        mpz_class z;
+        do {
+            z = random_bits(bits);
+            mpz_setbit(z.get_mpz_t(), bits - 1);
+            z = nextprime(z);
+        } while (mpz_sizeinbase(z.get_mpz_t(), 2) > bits);
+        return z;
+    }
+    if (!threads)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::atomic<bool> found{false};
+    std::mutex m;
+    mpz_class result;
+    auto worker = [&] {
+        if (mpz_class c; sieve_search(bits, found, c)) {
+            std::lock_guard lock{m};
+            if (!found.exchange(true))
+                result = c;
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads; ++i)
+        pool.emplace_back(worker);
+    worker();
+    for (auto &t : pool)
+        t.join();
+    return result;
+}
@@ -0,0 +1,211 @@
+//
+// Created by wtchr on 10/19/2026.
+//
+
+#include "tls/random.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <system_error>
+#include <vector>
+#include "tls/mpz.h"
+
+#if defined(__linux__)
+#include <cerrno>
+#include <sys/random.h>
+#endif
+#if !defined(_WIN32)
+#include <pthread.h>
+#endif
+
+namespace {
+    constexpr size_t key_size = 32; ///< ChaCha20 key size in bytes
+    constexpr size_t block_size = 64; ///< ChaCha20 block size in bytes
+    constexpr size_t buffer_blocks = 16; ///< Blocks generated per refill
+    constexpr uint64_t reseed_interval = 1 << 20; ///< Bytes of output between reseeds
+
+    std::atomic<uint64_t> fork_generation{0}; ///< Incremented in the child after every fork()
+
+    uint32_t rotl(const uint32_t x, const int n) {
+        return x << n | x >> (32 - n);
+    }
+
+    void quarter_round(uint32_t *x, const int a, const int b, const int c, const int d) {
+        x[a] += x[b];
+        x[d] = rotl(x[d] ^ x[a], 16);
+        x[c] += x[d];
+        x[b] = rotl(x[b] ^ x[c], 12);
+        x[a] += x[b];
+        x[d] = rotl(x[d] ^ x[a], 8);
+        x[c] += x[d];
+        x[b] = rotl(x[b] ^ x[c], 7);
+    }
+
+    /**
+     * @brief Computes one ChaCha20 block (RFC 8439) with a zero nonce.
+     */
+    void chacha20_block(const uint32_t *key, const uint32_t counter, unsigned char *out) {
+        uint32_t s[16] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};
+        std::copy_n(key, 8, s + 4);
+        s[12] = counter;
+        uint32_t x[16];
+        std::copy_n(s, 16, x);
+        for (int i = 0; i < 10; ++i) {
+            quarter_round(x, 0, 4, 8, 12);
+            quarter_round(x, 1, 5, 9, 13);
+            quarter_round(x, 2, 6, 10, 14);
+            quarter_round(x, 3, 7, 11, 15);
+            quarter_round(x, 0, 5, 10, 15);
+            quarter_round(x, 1, 6, 11, 12);
+            quarter_round(x, 2, 7, 8, 13);
+            quarter_round(x, 3, 4, 9, 14);
+        }
+        for (int i = 0; i < 16; ++i) {
+            const uint32_t v = x[i] + s[i];
+            for (int j = 0; j < 4; ++j)
+                out[4 * i + j] = static_cast<unsigned char>(v >> 8 * j);
+        }
+    }
+
+    /**
+     * @brief Reads seed material from the operating system.
+     * @throws std::system_error If the operating system cannot provide entropy.
+     */
+    void os_entropy(unsigned char *p, size_t len) {
+#if defined(__linux__)
+        while (len) {
+            const ssize_t n = getrandom(p, len, 0);
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                throw std::system_error(errno, std::generic_category(), "getrandom");
+            }
+            p += n;
+            len -= n;
+        }
+#else
+        std::random_device rd;
+        std::uniform_int_distribution<int> di{0, 0xff};
+        for (size_t i = 0; i < len; ++i)
+            p[i] = static_cast<unsigned char>(di(rd));
+#endif
+    }
+
+    void register_fork_handler() {
+#if !defined(_WIN32)
+        static std::once_flag flag;
+        std::call_once(flag, [] {
+            pthread_atfork(nullptr, nullptr, [] { fork_generation.fetch_add(1, std::memory_order_relaxed); });
+        });
+#endif
+    }
+
+    /**
+     * @brief Per-thread buffered ChaCha20 generator with fast key erasure.
+     */
+    class drbg {
+    public:
+        drbg() {
+            register_fork_handler();
+            reseed();
+        }
+
+        drbg(const drbg &) = delete;
+        drbg &operator=(const drbg &) = delete;
+
+        ~drbg() {
+            wipe();
+        }
+
+        void generate(unsigned char *p, size_t len) {
+            if (generation != fork_generation.load(std::memory_order_relaxed) || output >= reseed_interval)
+                reseed();
+            output += len;
+            while (len) {
+                if (pos == sizeof(buffer))
+                    refill();
+                const size_t n = std::min(len, sizeof(buffer) - pos);
+                std::copy_n(buffer + pos, n, p);
+                // Erase handed out bytes so they cannot be recovered from this thread's memory later.
+                std::fill_n(buffer + pos, n, 0);
+                pos += n;
+                p += n;
+                len -= n;
+            }
+        }
+
+    private:
+        uint32_t key[key_size / 4];
+        unsigned char buffer[buffer_blocks * block_size - key_size];
+        size_t pos = sizeof(buffer); ///< Next unused byte in buffer
+        uint64_t output = 0; ///< Bytes handed out since the last reseed
+        uint64_t generation = 0; ///< Fork generation the generator was seeded in
+
+        void reseed() {
+            unsigned char seed[key_size];
+            os_entropy(seed, key_size);
+            for (size_t i = 0; i < key_size / 4; ++i)
+                key[i] = static_cast<uint32_t>(seed[4 * i]) | static_cast<uint32_t>(seed[4 * i + 1]) << 8 |
+                         static_cast<uint32_t>(seed[4 * i + 2]) << 16 | static_cast<uint32_t>(seed[4 * i + 3]) << 24;
+            std::fill_n(seed, key_size, 0);
+            generation = fork_generation.load(std::memory_order_relaxed);
+            output = 0;
+            // Drop everything generated under the old key.
+            std::fill_n(buffer, sizeof(buffer), 0);
+            pos = sizeof(buffer);
+        }
+
+        void refill() {
+            unsigned char blocks[buffer_blocks * block_size];
+            for (uint32_t i = 0; i < buffer_blocks; ++i)
+                chacha20_block(key, i, blocks + i * block_size);
+            // The first 32 bytes become the next key, the rest is output.
+            for (size_t i = 0; i < key_size / 4; ++i)
+                key[i] = static_cast<uint32_t>(blocks[4 * i]) | static_cast<uint32_t>(blocks[4 * i + 1]) << 8 |
+                         static_cast<uint32_t>(blocks[4 * i + 2]) << 16 |
+                         static_cast<uint32_t>(blocks[4 * i + 3]) << 24;
+            std::copy_n(blocks + key_size, sizeof(buffer), buffer);
+            std::fill_n(blocks, sizeof(blocks), 0);
+            pos = 0;
+        }
+
+        void wipe() {
+            std::fill_n(key, key_size / 4, 0);
+            std::fill_n(buffer, sizeof(buffer), 0);
+        }
+    };
+
+    drbg &thread_drbg() {
+        thread_local drbg g;
+        return g;
+    }
+} // namespace
+
+void random_bytes(const std::span<unsigned char> out) {
+    thread_drbg().generate(out.data(), out.size());
+}
+
+mpz_class random_bits(const size_t bits) {
+    std::vector<unsigned char> buf((bits + 7) / 8);
+    random_bytes(buf);
+    if (bits % 8)
+        buf[0] &= static_cast<unsigned char>((1 << bits % 8) - 1);
+    mpz_class r = bnd2mpz(buf.begin(), buf.end());
+    std::fill(buf.begin(), buf.end(), 0);
+    return r;
+}
+
+mpz_class random_below(const mpz_class &n) {
+    assert(n > 0);
+    const size_t bits = mpz_sizeinbase(n.get_mpz_t(), 2);
+    mpz_class r;
+    do {
+        r = random_bits(bits);
+    } while (r >= n);
+    return r;
+}
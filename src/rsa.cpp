@@ -3,35 +3,308 @@
 //
 
 #include "tls/rsa.h"
+
+#include <algorithm>
+#include <future>
+#include <stdexcept>
+#include <thread>
 #include "tls/mpz.h"
+#include "tls/random.h"
+
+// Limbs of a non-negative number, zero-padded to n limbs.
+static std::vector<mp_limb_t> to_limbs(const mpz_class &a, const size_t n) {
+    std::vector<mp_limb_t> r(n, 0);
+    std::copy_n(mpz_limbs_read(a.get_mpz_t()), mpz_size(a.get_mpz_t()), r.begin());
+    return r;
+}
+
+// r = a * b mod m for n-limb operands, in constant time; prod needs 2 * n limbs.
+static void sec_mulmod(mp_limb_t *r, const mp_limb_t *a, const mp_limb_t *b, const mp_limb_t *m, const mp_size_t n,
+                       mp_limb_t *prod, mp_limb_t *tp) {
+    if (a == b)
+        mpn_sec_sqr(prod, a, n, tp);
+    else
+        mpn_sec_mul(prod, a, n, b, n, tp);
+    mpn_sec_div_r(prod, 2 * n, m, n, tp);
+    std::copy_n(prod, n, r);
+}
+
+rsa_class::rsa_class(const int key_size, const unsigned primes) {
+    generate_key(8 * static_cast<size_t>(key_size), primes);
+}
+
+rsa_class rsa_class::generate(const size_t bits, const unsigned primes) {
+    rsa_class r;
+    r.generate_key(bits, primes);
+    return r;
+}
 
-rsa_class::rsa_class(const int key_size) {
-    // Generate two random primes p and q
-    p = random_prime(key_size / 2);
-    q = random_prime(key_size / 2);
-    // Compute K = p * q, phi = lcm(p - 1, q - 1), and e such that gcd(e, phi) = 1
-    K = p * q;
-    phi = lcm(p - 1, q - 1);
+void rsa_class::generate_key(const size_t key_size, const unsigned primes) {
+    if (primes < 2 || primes > max_primes)
+        throw std::invalid_argument("RSA keys have 2 to 4 prime factors");
+    // Generate the primes concurrently, each searched on its share of the available threads. With two primes the
+    // top two bits of each guarantee the key size; with more, the product may come out one bit short.
+    const unsigned threads = std::max(1u, std::thread::hardware_concurrency() / primes);
+    const size_t bits = key_size / primes;
+    std::vector<mpz_class> r(primes);
+    const auto distinct = [&r] {
+        for (size_t i = 0; i < r.size(); ++i)
+            for (size_t j = 0; j < i; ++j)
+                if (r[i] == r[j])
+                    return false;
+        return true;
+    };
+    do {
+        std::vector<std::future<mpz_class>> f;
+        for (unsigned i = 0; i + 1 < primes; ++i)
+            f.push_back(std::async(std::launch::async, generate_prime, bits, threads));
+        r.back() = generate_prime(key_size - bits * (primes - 1), threads);
+        K = 1;
+        for (unsigned i = 0; i < primes; ++i) {
+            if (i + 1 < primes)
+                r[i] = f[i].get();
+            K *= r[i];
+        }
+    } while (!distinct() || mpz_sizeinbase(K.get_mpz_t(), 2) != key_size);
+    p = r[0];
+    q = r[1];
+    others.resize(primes - 2);
+    for (unsigned i = 2; i < primes; ++i)
+        others[i - 2].r = r[i];
+
+    // Compute phi = lcm(r_1 - 1, ..., r_u - 1), and e such that gcd(e, phi) = 1
+    phi = 1;
+    for (const auto &ri : r)
+        phi = lcm(phi, ri - 1);
     for (e = 0x10001; gcd(e, phi) != 1; e = nextprime(e)) {}
     mpz_invert(d.get_mpz_t(), e.get_mpz_t(), phi.get_mpz_t()); // d = e^-1 mod phi
+    mont = montgomery_context{K};
+    init_crt();
+    init_private();
+}
+
+// Throws unless K can be an RSA modulus.
+static void check_modulus(const mpz_class &K) {
+    if (K < 3 || mpz_even_p(K.get_mpz_t()))
+        throw std::invalid_argument("The modulus must be odd");
 }
 
 rsa_class::rsa_class(const mpz_class &e, const mpz_class &d, const mpz_class &K) {
+    check_modulus(K);
     this->e = e;
     this->d = d;
     this->K = K;
+    mont = montgomery_context{K};
+    init_private();
+}
+
+rsa_class::rsa_class(
+        const mpz_class &e, const mpz_class &d, const mpz_class &K, const mpz_class &p, const mpz_class &q,
+        const mpz_class &dp, const mpz_class &dq, const mpz_class &q_inv, const std::span<const other_prime> others
+) {
+    check_modulus(K);
+    if (others.size() > max_primes - 2)
+        throw std::invalid_argument("RSA keys have 2 to 4 prime factors");
+    mpz_class product = p * q;
+    for (const auto &o : others) {
+        if (o.r < 3)
+            throw std::invalid_argument("Invalid prime factor");
+        product *= o.r;
+    }
+    if (p < 3 || q < 3 || product != K)
+        throw std::invalid_argument("The prime factors must multiply to the modulus");
+    this->e = e;
+    this->d = d;
+    this->K = K;
+    this->p = p;
+    this->q = q;
+    this->others.assign(others.begin(), others.end());
+    init_crt();
+    if (dp != this->dp || dq != this->dq || q_inv != this->q_inv)
+        throw std::invalid_argument("Inconsistent CRT parameters");
+    for (size_t i = 0; i < others.size(); ++i)
+        if (others[i].d != this->others[i].d || others[i].t != this->others[i].t)
+            throw std::invalid_argument("Inconsistent CRT parameters");
+    mont = montgomery_context{K};
+    init_private();
+}
+
+void rsa_class::init_crt() {
+    dp = d % (p - 1);
+    dq = d % (q - 1);
+    mpz_invert(q_inv.get_mpz_t(), q.get_mpz_t(), p.get_mpz_t()); // q_inv = q^-1 mod p
+    mpz_class R = p * q; // Product of the preceding primes
+    for (auto &o : others) {
+        o.d = d % (o.r - 1);
+        mpz_invert(o.t.get_mpz_t(), R.get_mpz_t(), o.r.get_mpz_t());
+        R *= o.r;
+    }
+}
+
+void rsa_class::init_private() {
+    const size_t nk = mpz_size(K.get_mpz_t());
+    k_limbs = to_limbs(K, nk);
+    steps.clear();
+    const auto add_step = [&](const mpz_class &mod, const mpz_class &exp, const mpz_class &coeff,
+                              const mpz_class &product) {
+        const size_t n = mpz_size(mod.get_mpz_t());
+        const mp_bitcnt_t bits = std::max(mpz_sizeinbase(mod.get_mpz_t(), 2), mpz_sizeinbase(exp.get_mpz_t(), 2));
+        steps.push_back({
+                to_limbs(mod, n), to_limbs(exp, (bits + GMP_NUMB_BITS - 1) / GMP_NUMB_BITS), bits,
+                product == 0 ? std::vector<mp_limb_t>{} : to_limbs(coeff, n),
+                product == 0 ? std::vector<mp_limb_t>{} : to_limbs(product, mpz_size(product.get_mpz_t()))
+        });
+    };
+    if (q_inv == 0) {
+        add_step(K, d, 0, 0);
+    } else {
+        // Start from m = m_q, then fold in p with q_inv (RFC 8017) and every further prime with its t_i.
+        add_step(q, dq, 0, 0);
+        add_step(p, dp, q_inv, q);
+        mpz_class R = p * q;
+        for (const auto &o : others) {
+            add_step(o.r, o.d, o.t, R);
+            R *= o.r;
+        }
+    }
+
+    // GMP scratch for every call made by private_op(), then its own buffers.
+    mp_size_t itch = std::max({
+            mpn_sec_mul_itch(nk, nk), mpn_sec_sqr_itch(nk), mpn_sec_div_r_itch(2 * nk, nk)
+    });
+    for (const auto &s : steps) {
+        const auto n = static_cast<mp_size_t>(s.mod.size()), np = static_cast<mp_size_t>(s.product.size());
+        itch = std::max({
+                itch, mpn_sec_div_r_itch(nk, n), mpn_sec_div_r_itch(nk + 1, n),
+                mpn_sec_powm_itch(n, s.exp_bits, n), mpn_sec_mul_itch(n, n), mpn_sec_div_r_itch(2 * n, n),
+                np ? mpn_sec_mul_itch(std::max(np, n), std::min(np, n)) : 0
+        });
+    }
+    scratch_limbs = (nk + 2) + (2 * nk + 2) + 3 * nk + 2 * nk + static_cast<size_t>(itch);
+    if (blinding)
+        set_blinding(true);
+}
+
+void rsa_class::private_op(mp_limb_t *x) const {
+    const size_t nk = k_limbs.size();
+    thread_local std::vector<mp_limb_t> scratch;
+    if (scratch.size() < scratch_limbs)
+        scratch.resize(scratch_limbs);
+    mp_limb_t *acc = scratch.data(); // nk + 2 limbs
+    mp_limb_t *prod = acc + nk + 2; // 2 * nk + 2 limbs
+    mp_limb_t *red = prod + 2 * nk + 2;
+    mp_limb_t *mi = red + nk;
+    mp_limb_t *h = mi + nk;
+    mp_limb_t *factors = h + nk; // A and A^-1
+    mp_limb_t *tp = factors + 2 * nk;
+    const auto nks = static_cast<mp_size_t>(nk);
+
+    if (blinding) {
+        {
+            std::lock_guard lock{blinding->lock};
+            std::copy_n(blinding->A.data(), nk, factors);
+            std::copy_n(blinding->A_inv.data(), nk, factors + nk);
+            sec_mulmod(blinding->A.data(), factors, factors, k_limbs.data(), nks, prod, tp);
+            sec_mulmod(blinding->A_inv.data(), factors + nk, factors + nk, k_limbs.data(), nks, prod, tp);
+        }
+        sec_mulmod(x, x, factors, k_limbs.data(), nks, prod, tp);
+    }
+
+    // r = x^exp mod s.mod for a step with n-limb modulus.
+    const auto power = [&](mp_limb_t *r, const crt_step &s) {
+        const auto n = static_cast<mp_size_t>(s.mod.size());
+        std::copy_n(x, nk, red);
+        mpn_sec_div_r(red, nks, s.mod.data(), n, tp);
+        mpn_sec_powm(r, red, n, s.exp.data(), s.exp_bits, s.mod.data(), n, tp);
+    };
+
+    std::fill_n(acc, nk + 2, 0);
+    power(acc, steps[0]);
+    size_t len = steps[0].mod.size(); // Limbs of acc that may be non-zero
+    for (size_t i = 1; i < steps.size(); ++i) {
+        const crt_step &s = steps[i];
+        const size_t n = s.mod.size(), np = s.product.size();
+        const auto ns = static_cast<mp_size_t>(n);
+        power(mi, s);
+        // h = coeff * (m_i - acc) mod s.mod
+        const size_t l = std::max(len, n);
+        std::copy_n(acc, l, prod);
+        mpn_sec_div_r(prod, static_cast<mp_size_t>(l), s.mod.data(), ns, tp);
+        const mp_limb_t borrow = mpn_sub_n(h, mi, prod, ns);
+        mpn_cnd_add_n(borrow, h, h, s.mod.data(), ns);
+        sec_mulmod(h, h, s.coeff.data(), s.mod.data(), ns, prod, tp);
+        // acc += product * h
+        if (np >= n)
+            mpn_sec_mul(prod, s.product.data(), static_cast<mp_size_t>(np), h, ns, tp);
+        else
+            mpn_sec_mul(prod, h, ns, s.product.data(), static_cast<mp_size_t>(np), tp);
+        mpn_add_n(acc, acc, prod, static_cast<mp_size_t>(np + n));
+        len = np + n;
+    }
+    std::copy_n(acc, nk, x);
+
+    if (blinding)
+        sec_mulmod(x, x, factors + nk, k_limbs.data(), nks, prod, tp);
+}
+
+void rsa_class::set_blinding(const bool enable) {
+    if (!enable) {
+        blinding.reset();
+        return;
+    }
+    mpz_class r, r_inv;
+    do {
+        r = random_below(K - 2) + 2;
+    } while (mpz_invert(r_inv.get_mpz_t(), r.get_mpz_t(), K.get_mpz_t()) == 0);
+    auto b = std::make_shared<blinding_factors>();
+    b->A = to_limbs(mont.powm(r, e), k_limbs.size());
+    b->A_inv = to_limbs(r_inv, k_limbs.size());
+    blinding = std::move(b);
 }
 
 mpz_class rsa_class::sign(const mpz_class &m) const {
     return decode(m);
 }
 
+mpz_class rsa_class::sign(const std::span<const unsigned char> m) const {
+    return decode(bnd2mpz(m));
+}
+
 mpz_class rsa_class::encode(const mpz_class &m) const {
     // m should be less than K
-    return powm(m, e, K);
+    return mont.powm(m, e);
 }
 
-mpz_class rsa_class::decode(const mpz_class &m) const {
-    // m should be less than K
-    return powm(m, d, K);
+void rsa_class::sign(const std::span<const unsigned char> m, const std::span<unsigned char> out) const {
+    const size_t nk = k_limbs.size();
+    if (out.size() != (mpz_sizeinbase(K.get_mpz_t(), 2) + 7) / 8)
+        throw std::invalid_argument("The signature buffer must be as long as the modulus");
+    if (m.size() > out.size())
+        throw std::invalid_argument("Message representative out of range");
+    thread_local std::vector<mp_limb_t> x;
+    x.assign(nk, 0); // Reuses the capacity of earlier calls
+    for (size_t i = 0; i < m.size(); ++i)
+        x[i / sizeof(mp_limb_t)] |= static_cast<mp_limb_t>(m[m.size() - 1 - i]) << 8 * (i % sizeof(mp_limb_t));
+    if (mpn_cmp(x.data(), k_limbs.data(), static_cast<mp_size_t>(nk)) >= 0)
+        throw std::invalid_argument("Message representative out of range");
+    private_op(x.data());
+    for (size_t i = 0; i < out.size(); ++i)
+        out[out.size() - 1 - i] = static_cast<unsigned char>(x[i / sizeof(mp_limb_t)] >> 8 * (i % sizeof(mp_limb_t)));
 }
+
+mpz_class rsa_class::decode(const mpz_class &m) const {
+    mpz_class reduced;
+    const mpz_class *c = &m;
+    if (m < 0 || m >= K) {
+        mpz_mod(reduced.get_mpz_t(), m.get_mpz_t(), K.get_mpz_t());
+        c = &reduced;
+    }
+    const size_t nk = k_limbs.size();
+    mpz_class r;
+    mp_limb_t *x = mpz_limbs_write(r.get_mpz_t(), static_cast<mp_size_t>(nk));
+    std::fill_n(x, nk, 0);
+    std::copy_n(mpz_limbs_read(c->get_mpz_t()), mpz_size(c->get_mpz_t()), x);
+    private_op(x);
+    mpz_limbs_finish(r.get_mpz_t(), static_cast<mp_size_t>(nk));
+    return r;
+}
\ No newline at end of file
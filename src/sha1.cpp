@@ -5,7 +5,6 @@
 #include "tls/sha/sha1.h"
 
 #include <algorithm>
-#include "tls/mpz.h"
 
 static uint32_t left_rotate(const uint32_t a, const int bits) {
     return a << bits | a >> (32 - bits);
@@ -16,20 +15,59 @@ static uint32_t left_rotate(const uint32_t a, const int bits) {
 sha1::sha1() {
     if (constexpr uint32_t val = 0x12345678; htonl(val) == val)
         big_endian = true;
+    init();
 }
 
-void sha1::preprocess(std::vector<unsigned char> &v) {
-    const size_t len = v.size();
-    v.push_back(0x80);
-    size_t padding_size = block_size - (len + 1) % block_size;
-    if (padding_size < block_size / 8)
-        padding_size += block_size;
-    v.resize(len + 1 + padding_size, 0);
-    mpz2bnd(static_cast<unsigned long>(len * 8), v.end() - block_size / 8, v.end());
+void sha1::init() {
+    std::copy_n(h_stored_value, 5, h);
+    buffer_len = 0;
+    total_len = 0;
 }
 
-void sha1::process_chunk(unsigned char *p) {
+void sha1::absorb(const unsigned char *p, size_t len) {
+    total_len += len;
+    // Complete the pending block first.
+    if (buffer_len) {
+        const size_t n = std::min(len, block_size - buffer_len);
+        std::copy_n(p, n, buffer + buffer_len);
+        buffer_len += n;
+        p += n;
+        len -= n;
+        if (buffer_len < block_size)
+            return;
+        process_chunk(buffer);
+        buffer_len = 0;
+    }
+    for (; len >= block_size; p += block_size, len -= block_size)
+        process_chunk(p);
+    std::copy_n(p, len, buffer);
+    buffer_len = len;
+}
+
+std::array<unsigned char, sha1::output_size> sha1::digest() {
+    // Append the bit '1', pad with zeros and write the message length in bits to the end of the last block.
+    const uint64_t bits = total_len * 8;
+    buffer[buffer_len++] = 0x80;
+    if (buffer_len > block_size - 8) {
+        std::fill(buffer + buffer_len, buffer + block_size, 0);
+        process_chunk(buffer);
+        buffer_len = 0;
+    }
+    std::fill(buffer + buffer_len, buffer + block_size - 8, 0);
+    for (int i = 0; i < 8; ++i)
+        buffer[block_size - 1 - i] = static_cast<unsigned char>(bits >> 8 * i);
+    process_chunk(buffer);
+
+    std::array<unsigned char, output_size> result{};
+    for (size_t i = 0; i < output_size; ++i)
+        result[i] = static_cast<unsigned char>(h[i / 4] >> 8 * (3 - i % 4));
+    init();
+    return result;
+}
+
+void sha1::process_chunk(const unsigned char *p) {
     // Extend the 64-bytes block to 80 words (320 bytes).
+    uint32_t w[80];
     std::copy_n(p, 64, reinterpret_cast<unsigned char *>(w));
     if (!big_endian)
         for (int i = 0; i < 16; ++i)
@@ -0,0 +1,81 @@
+//
+// Created by wtchr on 10/19/2026.
+//
+
+#include "tls/x25519.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include "tls/fe25519.h"
+#include "tls/random.h"
+
+// The u-coordinate of the base point.
+static constexpr x25519::key_type base_point = {9};
+
+static x25519::key_type random_key() {
+    x25519::key_type k;
+    random_bytes(k);
+    return k;
+}
+
+static x25519::key_type copy_key(const std::span<const unsigned char, x25519::key_size> k) {
+    x25519::key_type r;
+    std::copy(k.begin(), k.end(), r.begin());
+    return r;
+}
+
+x25519::x25519()
+    : x25519{random_key()} {}
+
+x25519::x25519(const std::span<const unsigned char, key_size> private_key)
+    : x{copy_key(private_key)}
+    , y{scalar_mult(x, base_point)} {}
+
+x25519::key_type x25519::set_peer_public_key(const std::span<const unsigned char, key_size> pub_key) {
+    const key_type k = scalar_mult(x, pub_key);
+    unsigned char acc = 0;
+    for (const unsigned char c : k)
+        acc |= c;
+    if (acc == 0)
+        throw std::invalid_argument{"invalid X25519 public key"};
+    this->K = k;
+    return K;
+}
+
+x25519::key_type x25519::scalar_mult(
+        const std::span<const unsigned char, key_size> k, const std::span<const unsigned char, key_size> u
+) {
+    // Clamp: a multiple of the cofactor 8 with the top bit at position 254.
+    key_type e = copy_key(k);
+    e[0] &= 248;
+    e[31] &= 127;
+    e[31] |= 64;
+
+    // Montgomery ladder (RFC 7748, section 5): (x2 : z2) = m * U and (x3 : z3) = (m + 1) * U for the upper bits m of
+    // the scalar, swapped in constant time whenever consecutive bits differ.
+    constexpr uint32_t a24 = 121665; // (A - 2) / 4
+    const fe25519 x1 = fe25519::from_bytes(u.data());
+    fe25519 x2 = fe25519::one(), z2, x3 = x1, z3 = fe25519::one();
+    uint64_t swap = 0;
+    for (int t = 254; t >= 0; --t) {
+        const uint64_t bit = e[t / 8] >> (t % 8) & 1;
+        swap ^= bit;
+        fe25519::cswap(x2, x3, swap);
+        fe25519::cswap(z2, z3, swap);
+        swap = bit;
+
+        const fe25519 a = x2 + z2, aa = a.sqr(), b = x2 - z2, bb = b.sqr(), e2 = aa - bb;
+        const fe25519 c = x3 + z3, d = x3 - z3, da = d * a, cb = c * b;
+        x3 = (da + cb).sqr();
+        z3 = x1 * (da - cb).sqr();
+        x2 = aa * bb;
+        z2 = e2 * (aa + e2.mul_small(a24));
+    }
+    fe25519::cswap(x2, x3, swap);
+    fe25519::cswap(z2, z3, swap);
+
+    key_type r;
+    (x2 * z2.inv()).to_bytes(r.data());
+    return r;
+}
@@ -5,12 +5,38 @@
 #include "tls/diffie_hellman.h"
 #include <catch2/catch_test_macros.hpp>
 #include <iostream>
+#include <stdexcept>
+#include <vector>
 #include "tls/mpz.h"
+#include "tls/random.h"
 
 TEST_CASE("Diffie Hellman Key Exchange") {
     diffie_hellman alice, bob;
     REQUIRE(alice.set_peer_public_key(bob.y) == bob.set_peer_public_key(alice.y));
     REQUIRE(alice.K == bob.K);
+    // The shared secret is computed on the Montgomery context of p.
+    REQUIRE(alice.K == powm(bob.y, alice.x, alice.p));
+
+    SECTION("Exponent size") {
+        REQUIRE(mpz_sizeinbase(alice.x.get_mpz_t(), 2) <= diffie_hellman::default_exponent_bits);
+        diffie_hellman carol{2040};
+        REQUIRE(mpz_sizeinbase(carol.x.get_mpz_t(), 2) <= 2040);
+        REQUIRE(carol.set_peer_public_key(alice.y) == alice.set_peer_public_key(carol.y));
+    }
+
+    SECTION("Public key validation") {
+        REQUIRE(alice.validate_public_key(bob.y, true));
+        // The generator 2 is a quadratic residue modulo a safe prime p = 8k + 7.
+        REQUIRE(alice.validate_public_key(2, true));
+        const mpz_class invalid[] = {0, 1, alice.p - 1, alice.p, alice.p + 2};
+        for (const auto &bad : invalid) {
+            REQUIRE_FALSE(alice.validate_public_key(bad));
+            REQUIRE_THROWS_AS(alice.set_peer_public_key(bad), std::invalid_argument);
+        }
+        // -2 is a non-residue, so it lies outside the prime-order subgroup.
+        REQUIRE(alice.validate_public_key(alice.p - 2));
+        REQUIRE_FALSE(alice.validate_public_key(alice.p - 2, true));
+    }
 }
 
 TEST_CASE("Elliptic Curve Test") {
@@ -177,3 +203,163 @@ TEST_CASE("Elliptic Curve secp256k1") {
         REQUIRE(P.y == test_vector[i + 2]);
     }
 }
+
+TEST_CASE("Elliptic curve Jacobian coordinates") {
+    // One curve of each doubling shape: a = -3 (P-256), a = 0 (secp256k1), and a generic a.
+    const ec_field p256{
+            mpz_class{"0xffffffff00000001000000000000000000000000fffffffffffffffffffffffc"},
+            mpz_class{"0x5ac635d8aa3a93e7b3ebbd55769886bc651d06b0cc53b0f63bce3c3e27d2604b"},
+            mpz_class{"0xffffffff00000001000000000000000000000000ffffffffffffffffffffffff"}
+    };
+    const ec_field secp256k1{0, 7, mpz_class{"0xFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEFFFFFC2F"}};
+    const ec_field small{2, 2, 17};
+    const ec_point points[] = {
+            {mpz_class{"0x6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296"},
+             mpz_class{"0x4fe342e2fe1a7f9b8ee7eb4a7c0f9e162bce33576b315ececbb6406837bf51f5"}, p256},
+            {mpz_class{"0x79BE667EF9DCBBAC55A06295CE870B07029BFCDB2DCE28D959F2815B16F81798"},
+             mpz_class{"0x483ADA7726A3C4655DA4FBFC0E1108A8FD17B448A68554199C47D08FFB10D4B8"}, secp256k1},
+            {5, 1, small}
+    };
+
+    for (const auto &P : points) {
+        // Affine reference: P, 2P, ..., 20P by repeated addition.
+        ec_point Q = P;
+        for (int k = 1; k <= 20; ++k, Q = Q + P)
+            REQUIRE(k * P == Q);
+
+        // Full additions with Z != 1 on both sides.
+        auto A = P.to_jacobian(3 * P), B = P.to_jacobian(5 * P);
+        P.dbl(A);
+        P.dbl(B);
+        auto S = A;
+        P.add(S, B);
+        REQUIRE(P.to_affine(S) == 16 * P);
+        P.add(A, A);
+        REQUIRE(P.to_affine(A) == 12 * P);
+
+        // Identity cases.
+        const ec_point O = 0 * P;
+        REQUIRE(O.is_identity());
+        auto R = P.to_jacobian(P);
+        P.add(R, O);
+        REQUIRE(P.to_affine(R) == P);
+    }
+
+    // P + (-P) is the identity; the small curve has order 19.
+    const auto &P = points[2];
+    auto R = P.to_jacobian(7 * P);
+    P.add(R, 12 * P);
+    REQUIRE(P.to_affine(R).is_identity());
+    REQUIRE((19 * P).is_identity());
+}
+
+TEST_CASE("Elliptic curve scalar multiplication") {
+    const ec_field p256{
+            mpz_class{"0xffffffff00000001000000000000000000000000fffffffffffffffffffffffc"},
+            mpz_class{"0x5ac635d8aa3a93e7b3ebbd55769886bc651d06b0cc53b0f63bce3c3e27d2604b"},
+            mpz_class{"0xffffffff00000001000000000000000000000000ffffffffffffffffffffffff"}
+    };
+    const ec_point G{
+            mpz_class{"0x6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296"},
+            mpz_class{"0x4fe342e2fe1a7f9b8ee7eb4a7c0f9e162bce33576b315ececbb6406837bf51f5"}, p256
+    };
+    const mpz_class n{"0xffffffff00000000ffffffffffffffffbce6faada7179e84f3b9cac2fc632551"};
+
+    // Reference: plain double-and-add with affine additions.
+    const auto reference = [&](const mpz_class &k) {
+        ec_point r = 0 * G, x = G;
+        for (size_t i = 0; i < mpz_sizeinbase(k.get_mpz_t(), 2); ++i, x = x + x)
+            if (mpz_tstbit(k.get_mpz_t(), i))
+                r = r + x;
+        return r;
+    };
+
+    SECTION("Width-w NAF") {
+        for (const mpz_class &k : {mpz_class{1}, mpz_class{2}, mpz_class{31}, mpz_class{0xffff}, mpz_class{n - 1},
+                                   mpz_class{"0xaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"}, mpz_class{random_below(n)}})
+            REQUIRE(k * G == reference(k));
+        REQUIRE((n * G).is_identity());
+        REQUIRE((n - 1) * G == -G);
+    }
+
+    SECTION("Secret scalars") {
+        for (const mpz_class &k : {mpz_class{0}, mpz_class{1}, mpz_class{2}, mpz_class{n - 1}, mpz_class{n - 2},
+                                   mpz_class{random_below(n)}, mpz_class{random_below(n) | 1}})
+            REQUIRE(G.mul_secret(k, 256) == k * G);
+        REQUIRE(G.mul_secret(n - 1, 256) == -G);
+        REQUIRE(G.mul_secret(5, 3) == 5 * G);
+    }
+
+    SECTION("Fixed base") {
+        const ec_fixed_base table{G, 256};
+        for (const mpz_class &k : {mpz_class{0}, mpz_class{1}, mpz_class{2}, mpz_class{n - 1},
+                                   mpz_class{random_below(n)}, mpz_class{random_below(n) | 1}})
+            REQUIRE(table(k) == k * G);
+        REQUIRE(table(n).is_identity());
+    }
+
+    SECTION("Joint multiplication") {
+        const ec_point Q = random_below(n) * G;
+        const ec_wnaf_table g8{G, 8}, q5{Q, 5};
+        for (int i = 0; i < 3; ++i) {
+            const mpz_class u = random_below(n), v = random_below(n);
+            REQUIRE(mul_add(u, G, v, Q) == u * G + v * Q);
+            REQUIRE(mul_add(u, g8, v, q5) == u * G + v * Q);
+        }
+        REQUIRE(mul_add(0, g8, 12345, q5) == 12345 * Q);
+        REQUIRE(mul_add(7, g8, 0, q5) == 7 * G);
+        REQUIRE(mul_add(0, g8, 0, q5).is_identity());
+        REQUIRE(mul_add(n - 1, g8, 1, ec_wnaf_table{G, 3}).is_identity());
+    }
+
+    SECTION("Batch conversion to affine") {
+        std::vector<ec_jacobian> points;
+        for (int k = 1; k <= 5; ++k) {
+            points.push_back(G.to_jacobian(k * G));
+            G.dbl(points.back());
+        }
+        points.insert(points.begin() + 2, ec_jacobian{1, 1, 0});
+        const auto affine = G.to_affine(points);
+        REQUIRE(affine.size() == 6);
+        REQUIRE(affine[2].is_identity());
+        REQUIRE(affine[0] == 2 * G);
+        REQUIRE(affine[5] == 10 * G);
+    }
+}
+
+TEST_CASE("Elliptic curve fixed-limb arithmetic") {
+    const mpz_class p256_prime{"0xffffffff00000001000000000000000000000000ffffffffffffffffffffffff"};
+    const mpz_class k1_prime{"0xFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEFFFFFC2F"};
+    REQUIRE(ec_field{p256_prime - 3, 7, p256_prime}.field_arithmetic() == ec_field::arithmetic::p256);
+    REQUIRE(ec_field{0, 7, k1_prime}.field_arithmetic() == ec_field::arithmetic::secp256k1);
+    // Other curve shapes over the same primes, and other primes, keep the mpz arithmetic.
+    REQUIRE(ec_field{0, 7, p256_prime}.field_arithmetic() == ec_field::arithmetic::generic);
+    REQUIRE(ec_field{1, 7, k1_prime}.field_arithmetic() == ec_field::arithmetic::generic);
+    REQUIRE(ec_field{2, 2, 17}.field_arithmetic() == ec_field::arithmetic::generic);
+
+    // secp256k1 against affine double-and-add on mpz numbers.
+    const ec_field secp256k1{0, 7, k1_prime};
+    const ec_point G{
+            mpz_class{"0x79BE667EF9DCBBAC55A06295CE870B07029BFCDB2DCE28D959F2815B16F81798"},
+            mpz_class{"0x483ADA7726A3C4655DA4FBFC0E1108A8FD17B448A68554199C47D08FFB10D4B8"}, secp256k1
+    };
+    const mpz_class n{"0xFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFEBAAEDCE6AF48A03BBFD25E8CD0364141"};
+    const auto reference = [&](const mpz_class &k) {
+        ec_point r = 0 * G, x = G;
+        for (size_t i = 0; i < mpz_sizeinbase(k.get_mpz_t(), 2); ++i, x = x + x)
+            if (mpz_tstbit(k.get_mpz_t(), i))
+                r = r + x;
+        return r;
+    };
+    const ec_fixed_base table{G, 256};
+    const ec_point Q = reference(random_below(n));
+    for (const mpz_class &k : {mpz_class{1}, mpz_class{2}, mpz_class{n - 1}, mpz_class{random_below(n)}}) {
+        const ec_point R = reference(k);
+        REQUIRE(k * G == R);
+        REQUIRE(G.mul_secret(k, 256) == R);
+        REQUIRE(table(k) == R);
+        REQUIRE(mul_add(k, G, k, Q) == R + (k * Q));
+    }
+    REQUIRE((n * G).is_identity());
+    REQUIRE(table(n).is_identity());
+}
@@ -0,0 +1,61 @@
+//
+// Created by wtchr on 10/19/2026.
+//
+
+#include "tls/ec_curves.h"
+#include <catch2/catch_test_macros.hpp>
+#include <memory>
+#include "tls/ecdsa.h"
+#include "tls/random.h"
+
+TEST_CASE("Named elliptic curves") {
+    // A point is its two coordinates and one reference to the shared curve parameters.
+    STATIC_REQUIRE(sizeof(ec_point) == 2 * sizeof(mpz_class) + sizeof(std::shared_ptr<const void>));
+
+    const named_curve *curves[] = {&named_curve::p256(), &named_curve::p384(), &named_curve::secp256k1()};
+    for (const auto *c : curves) {
+        INFO(c->name);
+        const auto &G = c->G;
+        const mpz_class &p = G.modulus();
+        REQUIRE(mpz_probab_prime_p(p.get_mpz_t(), 25) > 0);
+        REQUIRE(mpz_probab_prime_p(c->n.get_mpz_t(), 25) > 0);
+        REQUIRE_FALSE(G.is_identity());
+        REQUIRE((c->n * G).is_identity());
+        REQUIRE(((c->n - 1) * G) == -G);
+
+        const mpz_class k = random_below(c->n - 1) + 1;
+        REQUIRE(k * G == G.mul_secret(k, mpz_sizeinbase(c->n.get_mpz_t(), 2)));
+        REQUIRE(&(k * G).modulus() == &p); // Derived points share the curve parameters.
+        REQUIRE(&c->field.modulus() == &p);
+
+        REQUIRE(named_curve::find(c->name) == c);
+    }
+
+    REQUIRE(mpz_sizeinbase(named_curve::p256().n.get_mpz_t(), 2) == 256);
+    REQUIRE(mpz_sizeinbase(named_curve::p384().n.get_mpz_t(), 2) == 384);
+    REQUIRE(named_curve::p256().field.field_arithmetic() == ec_field::arithmetic::p256);
+    REQUIRE(named_curve::p384().field.field_arithmetic() == ec_field::arithmetic::generic);
+    REQUIRE(named_curve::secp256k1().field.field_arithmetic() == ec_field::arithmetic::secp256k1);
+    REQUIRE(named_curve::find("secp256r1") == &named_curve::p256());
+    REQUIRE(named_curve::find("secp384r1") == &named_curve::p384());
+    REQUIRE(named_curve::find("P-521") == nullptr);
+
+    // The registry agrees with the parameters spelled out in hex.
+    const ec_field secp256r1{
+            mpz_class{"0xffffffff00000001000000000000000000000000fffffffffffffffffffffffc"},
+            mpz_class{"0x5ac635d8aa3a93e7b3ebbd55769886bc651d06b0cc53b0f63bce3c3e27d2604b"},
+            mpz_class{"0xffffffff00000001000000000000000000000000ffffffffffffffffffffffff"}
+    };
+    const ec_point G{
+            mpz_class{"0x6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296"},
+            mpz_class{"0x4fe342e2fe1a7f9b8ee7eb4a7c0f9e162bce33576b315ececbb6406837bf51f5"}, secp256r1
+    };
+    REQUIRE(G == named_curve::p256().G);
+    REQUIRE(named_curve::p256().n == mpz_class{"0xffffffff00000000ffffffffffffffffbce6faada7179e84f3b9cac2fc632551"});
+
+    for (const auto *c : curves) {
+        const ecdsa_class ecdsa{*c};
+        const mpz_class d = random_below(c->n - 1) + 1, m = random_bits(256);
+        REQUIRE(ecdsa.verify(m, ecdsa.sign(m, d), d * c->G));
+    }
+}
@@ -3,10 +3,15 @@
 //
 
 #include "tls/ecdsa.h"
+#include <algorithm>
 #include <array>
 #include <catch2/catch_test_macros.hpp>
 #include <nettle/sha.h>
+#include <string>
+#include <vector>
 #include "tls/mpz.h"
+#include "tls/random.h"
+#include "tls/sha/sha2.h"
 
 TEST_CASE("ECDSA") {
     const ec_field secp256r1{
@@ -35,4 +40,114 @@ TEST_CASE("ECDSA") {
     const auto z = bnd2mpz(digest, digest + SHA256_DIGEST_SIZE);
     const auto sign = ecdsa.sign(z, d);
     REQUIRE(ecdsa.verify(z, sign, Q));
+
+    // Byte-oriented overloads take the digest directly and interoperate with the integer ones.
+    const auto sign2 = ecdsa.sign(digest, d);
+    REQUIRE(ecdsa.verify(digest, sign2, Q));
+    REQUIRE(ecdsa.verify(z, sign2, Q));
+    REQUIRE(ecdsa.verify(digest, sign, Q));
+    digest[0] ^= 1;
+    REQUIRE_FALSE(ecdsa.verify(digest, sign, Q));
+}
+
+TEST_CASE("ECDSA batch verification") {
+    const ec_field secp256r1{
+            mpz_class{"0xffffffff00000001000000000000000000000000fffffffffffffffffffffffc"},
+            mpz_class{"0x5ac635d8aa3a93e7b3ebbd55769886bc651d06b0cc53b0f63bce3c3e27d2604b"},
+            mpz_class{"0xffffffff00000001000000000000000000000000ffffffffffffffffffffffff"}
+    };
+    const ec_point G{
+            mpz_class{"0x6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296"},
+            mpz_class{"0x4fe342e2fe1a7f9b8ee7eb4a7c0f9e162bce33576b315ececbb6406837bf51f5"}, secp256r1
+    };
+    const auto n = mpz_class{"0xffffffff00000000ffffffffffffffffbce6faada7179e84f3b9cac2fc632551"};
+    const ecdsa_class ecdsa{G, n};
+
+    std::vector<ecdsa_class::signed_message> batch;
+    for (int i = 0; i < 6; ++i) {
+        const mpz_class d = random_below(n - 1) + 1, m = random_bits(256);
+        batch.push_back({m, ecdsa.sign(m, d), d * G});
+    }
+    REQUIRE(ecdsa.verify_batch(batch) == std::vector<bool>(6, true));
+    REQUIRE(ecdsa.verify_batch({}).empty());
+
+    batch[1].m += 1; // Wrong message
+    batch[3].sig.second = n; // s out of range
+    batch[4].Q = batch[5].Q; // Wrong key
+    const auto result = ecdsa.verify_batch(batch);
+    REQUIRE(result == std::vector<bool>{true, false, true, false, false, true});
+    for (size_t i = 0; i < batch.size(); ++i)
+        REQUIRE(result[i] == ecdsa.verify(batch[i].m, batch[i].sig, batch[i].Q));
+}
+
+TEST_CASE("ECDSA deterministic nonces") {
+    // RFC 6979, appendix A.2.5 (P-256).
+    const ecdsa_class ecdsa{named_curve::p256()};
+    const mpz_class x{"0xc9afa9d845ba75166b5c215767b1d6934e50c3db36e89b127b8a622b120f6721"};
+    const auto Q = x * named_curve::p256().G;
+    REQUIRE(Q.x == mpz_class{"0x60fed4ba255a9d31c961eb74c6356d68c049b8923b61fa6ce669622e60f29fb6"});
+
+    const std::string sample = "sample", test = "test";
+    const auto sample256 = sha256{}.hash(sample.begin(), sample.end());
+    const auto test256 = sha256{}.hash(test.begin(), test.end());
+    const auto sample384 = sha384{}.hash(sample.begin(), sample.end());
+    const auto sample512 = sha512{}.hash(sample.begin(), sample.end());
+
+    auto sig = ecdsa.sign_deterministic<sha256>(sample256, x);
+    REQUIRE(sig.first == mpz_class{"0xefd48b2aacb6a8fd1140dd9cd45e81d69d2c877b56aaf991c34d0ea84eaf3716"});
+    REQUIRE(sig.second == mpz_class{"0xf7cb1c942d657c41d436c7a1b6e29f65f3e900dbb9aff4064dc4ab2f843acda8"});
+    REQUIRE(ecdsa.verify(sample256, sig, Q));
+    REQUIRE(ecdsa.sign_deterministic<sha256>(sample256, x) == sig);
+
+    sig = ecdsa.sign_deterministic<sha256>(test256, x);
+    REQUIRE(sig.first == mpz_class{"0xf1abb023518351cd71d881567b1ea663ed3efcf6c5132b354f28d3b0b7d38367"});
+    REQUIRE(sig.second == mpz_class{"0x019f4113742a2b14bd25926b49c649155f267e60d3814b4c0cc84250e46f0083"});
+
+    sig = ecdsa.sign_deterministic<sha384>(sample384, x);
+    REQUIRE(sig.first == mpz_class{"0x0eafea039b20e9b42309fb1d89e213057cbf973dc0cfc8f129edddc800ef7719"});
+    REQUIRE(sig.second == mpz_class{"0x4861f0491e6998b9455193e34e7b0d284ddd7149a74b95b9261f13abde940954"});
+    REQUIRE(ecdsa.verify(sample384, sig, Q));
+
+    sig = ecdsa.sign_deterministic<sha512>(sample512, x);
+    REQUIRE(sig.first == mpz_class{"0x8496a60b5e9b47c825488827e0495b0e3fa109ec4568fd3f8d1097678eb97f00"});
+    REQUIRE(sig.second == mpz_class{"0x2362ab1adbe2b8adf9cb9edab740ea6049c028114f2460f96554f61fae3302fe"});
+
+    // Randomized signatures of the same digest differ but verify.
+    const auto s1 = ecdsa.sign(sample256, x), s2 = ecdsa.sign(sample256, x);
+    REQUIRE(s1 != s2);
+    REQUIRE(ecdsa.verify(sample256, s1, Q));
+    REQUIRE(ecdsa.verify(sample256, s2, Q));
+}
+
+TEST_CASE("ECDSA presignatures") {
+    const auto &curve = named_curve::p256();
+    const ecdsa_class ecdsa{curve};
+    const mpz_class d = random_below(curve.n - 1) + 1;
+    const auto Q = d * curve.G;
+
+    const auto batch = ecdsa.presign(8);
+    REQUIRE(batch.size() == 8);
+    for (const auto &pre : batch) {
+        const mpz_class m = random_bits(256);
+        const auto sig = ecdsa.sign(m, d, pre);
+        REQUIRE(sig.first == pre.r);
+        REQUIRE(ecdsa.verify(m, sig, Q));
+    }
+    REQUIRE(batch[0].r != batch[1].r);
+    REQUIRE(ecdsa.presign(0).empty());
+
+    const mpz_class m = random_bits(256);
+    REQUIRE(ecdsa.verify(m, ecdsa.sign(m, d, ecdsa.presign()), Q));
+
+    ecdsa_presign_pool pool{ecdsa, 4, 8, 1, 4};
+    std::vector<mpz_class> r;
+    for (int i = 0; i < 12; ++i) {
+        const auto sig = pool.sign(m, d);
+        REQUIRE(ecdsa.verify(m, sig, Q));
+        r.push_back(sig.first);
+    }
+    std::sort(r.begin(), r.end());
+    REQUIRE(std::adjacent_find(r.begin(), r.end()) == r.end()); // Every nonce is used once.
+    const auto stats = pool.stats();
+    REQUIRE(stats.hits + stats.misses == 12);
 }
@@ -0,0 +1,118 @@
+//
+// Created by wtchr on 10/19/2026.
+//
+
+#include "tls/ed25519.h"
+#include <catch2/catch_test_macros.hpp>
+#include <nettle/eddsa.h>
+#include <string>
+#include <vector>
+#include "tls/mpz.h"
+#include "tls/random.h"
+
+namespace {
+    template<size_t N>
+    std::array<unsigned char, N> bytes(const char *hex) {
+        std::array<unsigned char, N> r;
+        mpz2bnd(mpz_class{hex}, r.begin(), r.end());
+        return r;
+    }
+} // namespace
+
+TEST_CASE("Ed25519") {
+    SECTION("RFC 8032 test vectors") {
+        const char *secret[] = {
+                "0x9d61b19deffd5a60ba844af492ec2cc44449c5697b326919703bac031cae7f60",
+                "0x4ccd089b28ff96da9db6c346ec114e0f5b8a319f35aba624da8cf6ed4fb8a6fb",
+                "0xc5aa8df43f9f837bedb7442f31dcb7b166d38535076f094b85ce3a2e0b4458f7",
+        };
+        const char *pub[] = {
+                "0xd75a980182b10ab7d54bfed3c964073a0ee172f3daa62325af021a68f707511a",
+                "0x3d4017c3e843895a92b70aa74d1b7ebc9c982ccf2ec4968cc0cd55f12af4660c",
+                "0xfc51cd8e6218a1a38da47ed00230f0580816ed13ba3303ac5deb911548908025",
+        };
+        const std::vector<unsigned char> message[] = {{}, {0x72}, {0xaf, 0x82}};
+        const char *signature[] = {
+                "0xe5564300c360ac729086e2cc806e828a84877f1eb8e5d974d873e065224901555fb8821590a33bacc61e39701cf9b46bd25bf5"
+                "f0595bbe24655141438e7a100b",
+                "0x92a009a9f0d4cab8720e820b5f642540a2b27b5416503f8fb3762223ebdb69da085ac1e43e15996e458f3613d0f11d8c387b2e"
+                "aeb4302aeeb00d291612bb0c00",
+                "0x6291d657deec24024827e69c3abe01a30ce548a284743a445e3680d7db5ac3ac18ff9b538d16f290ae67f760984dc6594a7c15"
+                "e9716ed28dc027beceea1ec40a",
+        };
+        for (int i = 0; i < 3; ++i) {
+            const ed25519 key{bytes<32>(secret[i])};
+            REQUIRE(key.public_key() == bytes<32>(pub[i]));
+            const auto sig = key.sign(message[i]);
+            REQUIRE(sig == bytes<64>(signature[i]));
+            REQUIRE(ed25519::verify(message[i], sig, key.public_key()));
+        }
+    }
+
+    SECTION("Interoperability with Nettle") {
+        const std::string message = "Hello, world!";
+        const std::span<const unsigned char> m{reinterpret_cast<const unsigned char *>(message.data()), message.size()};
+        ed25519::key_type secret, pub;
+        random_bytes(secret);
+        const ed25519 key{secret};
+        ed25519_sha512_public_key(pub.data(), secret.data());
+        REQUIRE(key.public_key() == pub);
+
+        ed25519::signature_type sig;
+        ed25519_sha512_sign(pub.data(), secret.data(), m.size(), m.data(), sig.data());
+        REQUIRE(key.sign(m) == sig);
+        REQUIRE(ed25519::verify(m, sig, pub));
+        REQUIRE(ed25519_sha512_verify(pub.data(), m.size(), m.data(), key.sign(m).data()));
+    }
+
+    SECTION("Rejected signatures") {
+        const ed25519 key;
+        const std::vector<unsigned char> m = {1, 2, 3};
+        auto sig = key.sign(m);
+        REQUIRE(ed25519::verify(m, sig, key.public_key()));
+        REQUIRE_FALSE(ed25519::verify(std::vector<unsigned char>{1, 2, 4}, sig, key.public_key()));
+        REQUIRE_FALSE(ed25519::verify(m, sig, ed25519{}.public_key()));
+
+        // S + L encodes the same scalar but is not canonical.
+        auto malleable = sig;
+        const mpz_class L = (mpz_class{1} << 252) + mpz_class{"27742317777372353535851937790883648493"};
+        std::reverse(malleable.begin() + 32, malleable.end());
+        mpz_class S = bnd2mpz(malleable.begin() + 32, malleable.end()) + L;
+        mpz2bnd(S, malleable.begin() + 32, malleable.end());
+        std::reverse(malleable.begin() + 32, malleable.end());
+        REQUIRE_FALSE(ed25519::verify(m, malleable, key.public_key()));
+
+        // A y-coordinate of p (non-canonical) and one with no matching x.
+        auto bad_key = key.public_key();
+        bad_key.fill(0xff);
+        bad_key[0] = 0xed;
+        bad_key[31] = 0x7f;
+        REQUIRE_FALSE(ed25519::verify(m, sig, bad_key));
+        bad_key = ed25519::key_type{2};
+        REQUIRE_FALSE(ed25519::verify(m, sig, bad_key));
+
+        sig[0] ^= 1;
+        REQUIRE_FALSE(ed25519::verify(m, sig, key.public_key()));
+    }
+
+    SECTION("Batch verification") {
+        std::vector<std::vector<unsigned char>> messages;
+        std::vector<ed25519::signed_message> batch;
+        for (int i = 0; i < 8; ++i)
+            messages.push_back({static_cast<unsigned char>(i), 42});
+        for (const auto &m : messages) {
+            const ed25519 key;
+            batch.push_back({m, key.sign(m), key.public_key()});
+        }
+        REQUIRE(ed25519::verify_batch(batch) == std::vector<bool>(8, true));
+        REQUIRE(ed25519::verify_batch({}).empty());
+
+        batch[1].sig[40] ^= 1; // Wrong S
+        batch[3].public_key = batch[4].public_key; // Wrong key
+        batch[6].sig[0] ^= 1; // Wrong R
+        const auto result = ed25519::verify_batch(batch);
+        REQUIRE(result == std::vector<bool>{true, false, true, false, true, true, false, true});
+        for (size_t i = 0; i < batch.size(); ++i)
+            REQUIRE(result[i] == ed25519::verify(batch[i].message, batch[i].sig, batch[i].public_key));
+    }
+}
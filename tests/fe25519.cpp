@@ -0,0 +1,76 @@
+//
+// Created by wtchr on 10/19/2026.
+//
+
+#include "tls/fe25519.h"
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+#include "tls/mpz.h"
+#include "tls/random.h"
+
+namespace {
+    const mpz_class p = (mpz_class{1} << 255) - 19;
+
+    fe25519 from_mpz(const mpz_class &a) {
+        unsigned char b[32];
+        mpz2bnd(a, std::begin(b), std::end(b));
+        std::reverse(std::begin(b), std::end(b));
+        return fe25519::from_bytes(b);
+    }
+
+    mpz_class to_mpz(const fe25519 &a) {
+        unsigned char b[32];
+        a.to_bytes(b);
+        std::reverse(std::begin(b), std::end(b));
+        return bnd2mpz(std::begin(b), std::end(b));
+    }
+} // namespace
+
+TEST_CASE("Curve25519 field arithmetic") {
+    const mpz_class edge[] = {0, 1, 2, 19, p - 1, p - 2, (p + 1) / 2, (mpz_class{1} << 255) - 1};
+    std::vector<mpz_class> values(std::begin(edge), std::end(edge));
+    for (int i = 0; i < 20; ++i)
+        values.push_back(random_below(p));
+
+    REQUIRE(to_mpz(fe25519::one()) == 1);
+    REQUIRE(fe25519{}.is_zero());
+    // Non-canonical encodings (p and above) decode to their residue.
+    REQUIRE(from_mpz(p).is_zero());
+    REQUIRE(to_mpz(from_mpz(p + 5)) == 5);
+    for (const auto &a : values) {
+        const auto x = from_mpz(a);
+        REQUIRE(to_mpz(x) == a % p);
+        REQUIRE(x.is_zero() == (a % p == 0));
+        REQUIRE(x.is_negative() == (a % p % 2 == 1));
+        REQUIRE(to_mpz(x.sqr()) == a * a % p);
+        REQUIRE(to_mpz(-x) == (p - a % p) % p);
+        REQUIRE(to_mpz(x.mul_small(121665)) == a * 121665 % p);
+        if (a % p != 0)
+            REQUIRE(to_mpz(x * x.inv()) == 1);
+        for (const auto &b : edge) {
+            const auto y = from_mpz(b);
+            REQUIRE(to_mpz(x + y) == (a + b) % p);
+            REQUIRE(to_mpz(x - y) == ((a - b) % p + p) % p);
+            REQUIRE(to_mpz(x * y) == a * b % p);
+        }
+    }
+
+    // Long chains stay within the limb bounds.
+    fe25519 x = from_mpz(p - 1), y = x;
+    mpz_class a = p - 1, b = a;
+    for (int i = 0; i < 100; ++i) {
+        x = (x + y) * (x - y) + x;
+        a = ((a + b) * (a - b) + a) % p;
+        if (a < 0)
+            a += p;
+    }
+    REQUIRE(to_mpz(x) == a);
+
+    fe25519 u = fe25519::one(), v = from_mpz(2);
+    fe25519::cswap(u, v, 0);
+    REQUIRE(to_mpz(u) == 1);
+    fe25519::cswap(u, v, 1);
+    REQUIRE(to_mpz(u) == 2);
+    REQUIRE(to_mpz(v) == 1);
+}
@@ -0,0 +1,48 @@
+//
+// Created by wtchr on 10/19/2026.
+//
+
+#include "tls/fe256.h"
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+#include "tls/random.h"
+
+namespace {
+    template<class Field>
+    void check_field() {
+        using fe = fe256<Field>;
+        mpz_class p;
+        mpz_import(p.get_mpz_t(), 4, -1, sizeof(mp_limb_t), 0, 0, Field::p.data());
+        const mpz_class edge[] = {0, 1, 2, p - 1, p - 2, (p + 1) / 2};
+        std::vector<mpz_class> values(std::begin(edge), std::end(edge));
+        for (int i = 0; i < 20; ++i)
+            values.push_back(random_below(p));
+
+        REQUIRE(fe::one().to_mpz() == 1);
+        REQUIRE(fe{}.is_zero());
+        for (const auto &a : values) {
+            const auto x = fe::from_mpz(a);
+            REQUIRE(x.to_mpz() == a);
+            REQUIRE(x.is_zero() == (a == 0));
+            REQUIRE(x.sqr().to_mpz() == a * a % p);
+            if (a != 0)
+                REQUIRE((x * x.inv()).to_mpz() == 1);
+            for (const auto &b : edge) {
+                const auto y = fe::from_mpz(b);
+                REQUIRE((x + y).to_mpz() == (a + b) % p);
+                REQUIRE((x - y).to_mpz() == ((a - b) % p + p) % p);
+                REQUIRE((x * y).to_mpz() == a * b % p);
+            }
+        }
+    }
+} // namespace
+
+TEST_CASE("Fixed-limb field arithmetic") {
+    SECTION("P-256") {
+        check_field<p256_field>();
+    }
+
+    SECTION("secp256k1") {
+        check_field<secp256k1_field>();
+    }
+}
@@ -7,6 +7,7 @@
 
 #include "tls/mpz.h"
 #include "tls/sha/sha1.h"
+#include "tls/sha/sha2.h"
 
 TEST_CASE("HMAC-SHA1") {
     const std::string data[] = {
@@ -39,3 +40,28 @@ TEST_CASE("HMAC-SHA1") {
         REQUIRE(std::equal(h.begin(), h.end(), nresult));
     }
 }
+
+TEST_CASE("HMAC-SHA256") {
+    // RFC 4231 test cases 1, 2 and 6 (key longer than the block size)
+    const std::string data[] = {
+            "Hi There", "what do ya want for nothing?", "Test Using Larger Than Block-Size Key - Hash Key First"
+    };
+    const std::string key[] = {std::string(20, '\x0b'), "Jefe", std::string(131, '\xaa')};
+    const char *expected[] = {
+            "0xb0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7",
+            "0x5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843",
+            "0x60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54"
+    };
+
+    hmac<sha256> hmac;
+    for (int i = 0; i < 3; ++i) {
+        unsigned char nresult[32];
+        mpz2bnd(mpz_class{expected[i]}, nresult, nresult + 32);
+        hmac.key(key[i].begin(), key[i].end());
+        // The keyed midstates must be reusable for any number of messages.
+        for (int j = 0; j < 2; ++j) {
+            auto h = hmac.hash(data[i].begin(), data[i].end());
+            REQUIRE(std::equal(h.begin(), h.end(), nresult));
+        }
+    }
+}
@@ -0,0 +1,88 @@
+//
+// Created by wtchr on 10/19/2026.
+//
+
+#include "tls/kdf.h"
+#include <catch2/catch_test_macros.hpp>
+#include <stdexcept>
+#include <vector>
+
+#include "tls/mpz.h"
+#include "tls/sha/sha2.h"
+
+TEST_CASE("TLS 1.2 PRF") {
+    unsigned char secret[16], seed[16], expected[100], out[100];
+    mpz2bnd(mpz_class{"0x9bbe436ba940f017b17652849a71db35"}, secret, secret + 16);
+    mpz2bnd(mpz_class{"0xa0ba9f936cda311827a6f796ffd5198c"}, seed, seed + 16);
+    const std::string label = "test label";
+
+    SECTION("SHA-256") {
+        mpz2bnd(mpz_class{"0xe3f229ba727be17b8d122620557cd453c2aab21d07c3d495329b52d4e61edb5a6b301791e90d35c9c9a46b4e14baf9a"
+                          "f0fa022f7077def17abfd3797c0564bab4fbc91666e9def9b97fce34f796789baa48082d122ee42c5a72e5a5110fff7"
+                          "0187347b66"},
+                expected, expected + 100);
+        prf<sha256> p;
+        p.secret(secret, secret + 16);
+        p.expand(label.begin(), label.end(), seed, seed + 16, out, out + 100);
+        REQUIRE(std::equal(out, out + 100, expected));
+        // A shorter output is a prefix of the longer one.
+        std::fill_n(out, 100, 0);
+        p.expand(label.begin(), label.end(), seed, seed + 16, out, out + 13);
+        REQUIRE(std::equal(out, out + 13, expected));
+        REQUIRE(out[13] == 0);
+    }
+
+    SECTION("SHA-384") {
+        mpz2bnd(mpz_class{"0xdd88775cd827187b67a3f7652b5c13f715791cc46e0274a6d3fb16651103defc544cd8afb68369a219bb918b8b21ddb"
+                          "1764af0a70339e6dec085e574f655851ba692513203536bdfc3675e53768210f0a2389dd324311a440c7c30ef44b391"
+                          "d914c3b0c7"},
+                expected, expected + 100);
+        prf<sha384> p;
+        p.secret(secret, secret + 16);
+        p.expand(label.begin(), label.end(), seed, seed + 16, out, out + 100);
+        REQUIRE(std::equal(out, out + 100, expected));
+    }
+}
+
+TEST_CASE("HKDF") {
+    // RFC 5869 test cases 1 and 3
+    unsigned char ikm[22], salt[13], info[10], prk[32], okm[42], out[42];
+    std::fill_n(ikm, 22, 0x0b);
+    mpz2bnd(mpz_class{"0x000102030405060708090a0b0c"}, salt, salt + 13);
+    mpz2bnd(mpz_class{"0xf0f1f2f3f4f5f6f7f8f9"}, info, info + 10);
+    hkdf<sha256> h;
+
+    SECTION("With salt and info") {
+        mpz2bnd(mpz_class{"0x077709362c2e32df0ddc3f0dc47bba6390b6c73bb50f9c3122ec844ad7c2b3e5"}, prk, prk + 32);
+        mpz2bnd(mpz_class{"0x3cb25f25faacd57a90434f64d0362f2a2d2d0a90cf1a5a4c5db02d56ecc4c5bf34007208d5b887185865"}, okm,
+                okm + 42);
+        const auto p = h.extract(salt, salt + 13, ikm, ikm + 22);
+        REQUIRE(std::equal(p.begin(), p.end(), prk));
+        h.expand(info, info + 10, out, out + 42);
+        REQUIRE(std::equal(out, out + 42, okm));
+    }
+
+    SECTION("Without salt and info") {
+        mpz2bnd(mpz_class{"0x19ef24a32c717b167f33a91d6f648bdf96596776afdb6377ac434c1c293ccb04"}, prk, prk + 32);
+        mpz2bnd(mpz_class{"0x8da4e775a563c18f715f802a063c5a31b8a11f5c5ee1879ec3454e5f3c738d2d9d201395faa4b61a96c8"}, okm,
+                okm + 42);
+        const auto p = h.extract(salt, salt, ikm, ikm + 22);
+        REQUIRE(std::equal(p.begin(), p.end(), prk));
+        h.expand(info, info, out, out + 42);
+        REQUIRE(std::equal(out, out + 42, okm));
+
+        // Loading the PRK directly gives the same output.
+        hkdf<sha256> h2;
+        h2.key(prk, prk + 32);
+        std::fill_n(out, 42, 0);
+        h2.expand(info, info, out, out + 42);
+        REQUIRE(std::equal(out, out + 42, okm));
+    }
+
+    SECTION("Output length limit") {
+        h.extract(salt, salt, ikm, ikm + 22);
+        std::vector<unsigned char> long_out(255 * 32 + 1);
+        REQUIRE_NOTHROW(h.expand(info, info, long_out.begin(), long_out.end() - 1));
+        REQUIRE_THROWS_AS(h.expand(info, info, long_out.begin(), long_out.end()), std::invalid_argument);
+    }
+}
@@ -0,0 +1,122 @@
+//
+// Created by wtchr on 10/19/2026.
+//
+
+#include "tls/keypair_pool.h"
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <set>
+#include <thread>
+#include <vector>
+#include "tls/diffie_hellman.h"
+#include "tls/mpmc_queue.h"
+
+namespace {
+    template<typename Keypair>
+    bool wait_for_available(const keypair_pool<Keypair> &pool, const size_t n) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{30};
+        while (pool.stats().available < n) {
+            if (std::chrono::steady_clock::now() > deadline)
+                return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+        return true;
+    }
+} // namespace
+
+TEST_CASE("MPMC queue") {
+    SECTION("Capacity") {
+        mpmc_queue<int> q{5};
+        REQUIRE(q.capacity() == 8);
+        for (int i = 0; i < 8; ++i)
+            REQUIRE(q.try_push(int{i}));
+        REQUIRE_FALSE(q.try_push(8));
+        for (int i = 0; i < 8; ++i)
+            REQUIRE(q.try_pop() == i);
+        REQUIRE_FALSE(q.try_pop());
+    }
+
+    SECTION("Concurrent producers and consumers") {
+        constexpr int count = 10000;
+        mpmc_queue<int> q{64};
+        std::atomic<long> sum{0};
+        std::atomic<int> popped{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 2; ++t) {
+            threads.emplace_back([&, t] {
+                for (int i = t; i < count; i += 2)
+                    while (!q.try_push(int{i}))
+                        std::this_thread::yield();
+            });
+            threads.emplace_back([&] {
+                while (popped.load() < count) {
+                    if (const auto v = q.try_pop()) {
+                        sum += *v;
+                        ++popped;
+                    } else {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        for (auto &t : threads)
+            t.join();
+        REQUIRE(popped == count);
+        REQUIRE(sum == static_cast<long>(count) * (count - 1) / 2);
+    }
+}
+
+TEST_CASE("Keypair pool") {
+    SECTION("Diffie-Hellman") {
+        keypair_pool<diffie_hellman> pool{[] { return diffie_hellman{}; }, 2, 4};
+        REQUIRE(wait_for_available(pool, 4));
+
+        std::set<mpz_class> keys;
+        for (int i = 0; i < 6; ++i) {
+            const auto dh = pool.take();
+            REQUIRE(dh.validate_public_key(dh.y));
+            keys.insert(dh.y);
+        }
+        REQUIRE(keys.size() == 6);
+
+        const auto stats = pool.stats();
+        REQUIRE(stats.hits + stats.misses == 6);
+        REQUIRE(stats.hits >= 4);
+        REQUIRE(stats.generated >= stats.hits);
+    }
+
+    SECTION("Elliptic curve") {
+        const ec_field secp256k1{
+                mpz_class{0}, mpz_class{7},
+                mpz_class{"0xfffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2f"}
+        };
+        const ec_point G{
+                mpz_class{"0x79be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798"},
+                mpz_class{"0x483ada7726a3c4655da4fbfc0e1108a8fd17b448a68554199c47d08ffb10d4b8"}, secp256k1
+        };
+        const mpz_class n{"0xfffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364141"};
+
+        keypair_pool<ec_keypair> pool{[&] { return ec_keypair{G, n}; }, 1, 2, 2};
+        REQUIRE(wait_for_available(pool, 2));
+
+        const auto a = pool.take();
+        const auto b = pool.take();
+        REQUIRE(a.d != b.d);
+        REQUIRE(a.Q == a.d * G);
+        REQUIRE(b.Q == b.d * G);
+        REQUIRE(pool.stats().hits == 2);
+    }
+
+    SECTION("Batches") {
+        std::atomic<int> next{0};
+        const auto one = [&] { return next.fetch_add(1); };
+        keypair_pool<int> pool{one, [&] { return std::vector<int>{one(), one(), one()}; }, 4, 8};
+        REQUIRE(wait_for_available(pool, 8));
+
+        std::set<int> keys;
+        for (int i = 0; i < 10; ++i)
+            keys.insert(pool.take());
+        REQUIRE(keys.size() == 10);
+        REQUIRE(pool.stats().hits >= 8);
+    }
+}
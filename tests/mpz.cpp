@@ -4,6 +4,8 @@
 
 #include "tls/mpz.h"
 #include <catch2/catch_test_macros.hpp>
+#include <list>
+#include "tls/random.h"
 
 TEST_CASE("mpz") {
     uint8_t arr[8];
@@ -12,3 +14,87 @@ TEST_CASE("mpz") {
     mpz_class b = bnd2mpz(arr, arr + 8);
     REQUIRE(a == b);
 }
+
+TEST_CASE("Big endian conversion") {
+    unsigned char arr[12];
+
+    SECTION("Zero padding and truncation") {
+        mpz2bnd(mpz_class{"0x1234"}, arr, arr + 4);
+        REQUIRE((arr[0] == 0 && arr[1] == 0 && arr[2] == 0x12 && arr[3] == 0x34));
+        mpz2bnd(mpz_class{"0x112233445566778899aabbccddeeff"}, arr, arr + 12);
+        REQUIRE(bnd2mpz(arr, arr + 12) == mpz_class{"0x445566778899aabbccddeeff"});
+        mpz2bnd(mpz_class{0}, arr, arr + 12);
+        REQUIRE(std::all_of(arr, arr + 12, [](auto c) { return c == 0; }));
+        REQUIRE(bnd2mpz(arr, arr) == 0);
+    }
+
+    SECTION("Fixed-width integers") {
+        mpz2bnd(0x1122334455667788ULL, arr, arr + 12);
+        REQUIRE(bnd2mpz(arr, arr + 12) == mpz_class{"0x1122334455667788"});
+        REQUIRE(bnd2int<uint64_t>(arr, arr + 12) == 0x1122334455667788ULL);
+        REQUIRE(bnd2int<uint32_t>(arr, arr + 12) == 0x55667788);
+        mpz2bnd(0x1234, arr, arr + 1);
+        REQUIRE(arr[0] == 0x34);
+    }
+
+    SECTION("Spans and non-contiguous iterators") {
+        const mpz_class a{"0xfedcba9876543210fedcba98"};
+        mpz2bnd(a, std::span{arr});
+        REQUIRE(bnd2mpz(std::span<const unsigned char>{arr}) == a);
+        std::list<unsigned char> l(12);
+        mpz2bnd(a, l.begin(), l.end());
+        REQUIRE(std::equal(l.begin(), l.end(), arr));
+        REQUIRE(bnd2mpz(l.begin(), l.end()) == a);
+    }
+
+    SECTION("Limbs") {
+        constexpr mp_limb_t limbs[] = {0x1122334455667788, 0x99aabbccddeeff00, 0};
+        REQUIRE(limbs2mpz(limbs) == mpz_class{"0x99aabbccddeeff001122334455667788"});
+        REQUIRE(limbs2mpz(std::span(limbs, 1)) == 0x1122334455667788);
+        REQUIRE(limbs2mpz({}) == 0);
+    }
+}
+
+TEST_CASE("Prime generation") {
+    for (const size_t bits : {24, 100, 512, 1024}) {
+        const auto a = generate_prime(bits, 4);
+        const auto b = generate_prime(bits);
+        REQUIRE(mpz_sizeinbase(a.get_mpz_t(), 2) == bits);
+        REQUIRE(mpz_probab_prime_p(a.get_mpz_t(), 30) > 0);
+        REQUIRE(mpz_probab_prime_p(b.get_mpz_t(), 30) > 0);
+        REQUIRE(a != b);
+    }
+}
+
+TEST_CASE("Fixed-base exponentiation") {
+    const mpz_class mod = generate_prime(512);
+    const mpz_class g = 3;
+    for (const unsigned window : {1, 4, 8}) {
+        const fixed_base_powm fb{g, mod, 300, window};
+        REQUIRE(fb(0) == 1);
+        REQUIRE(fb(1) == g);
+        for (const size_t bits : {7, 64, 255, 300, 301, 600}) {
+            const mpz_class e = random_bits(bits);
+            REQUIRE(fb(e) == powm(g, e, mod));
+        }
+    }
+}
+
+TEST_CASE("Montgomery exponentiation") {
+    const mpz_class mod = generate_prime(256) * generate_prime(300);
+    const montgomery_context ctx{mod};
+    REQUIRE(ctx.modulus() == mod);
+    REQUIRE(ctx.powm(5, 0) == 1);
+    REQUIRE(ctx.powm(5, 1) == 5);
+    REQUIRE(ctx.powm(0, 7) == 0);
+    REQUIRE(ctx.powm(mod - 1, 2) == 1);
+    REQUIRE(ctx.powm(-2, 3) == mod - 8);
+    REQUIRE(ctx.powm(mod + 3, 2) == 9);
+    for (const size_t bits : {2, 17, 64, 100, 300, 556, 1024}) {
+        const mpz_class b = random_below(mod), e = random_bits(bits);
+        REQUIRE(ctx.powm(b, e) == powm(b, e, mod));
+    }
+
+    const montgomery_context even{mpz_class{1} << 100};
+    REQUIRE(even.powm(3, 100) == powm(3, 100, mpz_class{1} << 100));
+}
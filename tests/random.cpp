@@ -0,0 +1,74 @@
+//
+// Created by wtchr on 10/19/2026.
+//
+
+#include "tls/random.h"
+#include <algorithm>
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+TEST_CASE("Random bytes") {
+    std::array<unsigned char, 1000> a{}, b{};
+    random_bytes(a);
+    random_bytes(b);
+    REQUIRE(a != b);
+    // Odd sizes that straddle the internal buffer.
+    for (size_t len : {1, 31, 32, 33, 959, 960, 961}) {
+        std::array<unsigned char, 961> c{};
+        random_bytes(std::span{c}.first(len));
+        REQUIRE(std::all_of(c.begin() + len, c.end(), [](auto x) { return x == 0; }));
+    }
+
+    SECTION("Threads have independent generators") {
+        std::array<unsigned char, 32> t{};
+        std::thread th{[&t] { random_bytes(t); }};
+        th.join();
+        random_bytes(a);
+        REQUIRE(!std::equal(t.begin(), t.end(), a.begin()));
+    }
+
+#if !defined(_WIN32)
+    SECTION("Fork safety") {
+        // The child must not repeat the parent's buffered stream.
+        random_bytes(std::span{a}.first(1)); // Make sure the generator has buffered output.
+        int fd[2];
+        REQUIRE(pipe(fd) == 0);
+        const pid_t pid = fork();
+        REQUIRE(pid >= 0);
+        if (pid == 0) {
+            random_bytes(b);
+            [[maybe_unused]] auto n = write(fd[1], b.data(), b.size());
+            _exit(0);
+        }
+        close(fd[1]);
+        random_bytes(a);
+        size_t got = 0;
+        for (ssize_t n; got < b.size() && (n = read(fd[0], b.data() + got, b.size() - got)) > 0;)
+            got += n;
+        close(fd[0]);
+        waitpid(pid, nullptr, 0);
+        REQUIRE(got == b.size());
+        REQUIRE(a != b);
+    }
+#endif
+}
+
+TEST_CASE("Random numbers") {
+    const mpz_class n{"0x1000000000000000000000000000000000000000000000000000000000000001"};
+    mpz_class max = 0;
+    for (int i = 0; i < 200; ++i) {
+        const auto r = random_below(n);
+        REQUIRE(r >= 0);
+        REQUIRE(r < n);
+        max = std::max(max, r);
+        REQUIRE(random_bits(13) < 1 << 13);
+    }
+    // The bound is just above a power of two, so samples must still use all 252 bits.
+    REQUIRE(mpz_sizeinbase(max.get_mpz_t(), 2) > 240);
+}
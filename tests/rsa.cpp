@@ -3,7 +3,12 @@
 //
 
 #include "tls/rsa.h"
+#include <array>
 #include <catch2/catch_test_macros.hpp>
+#include <stdexcept>
+#include <vector>
+#include "tls/mpz.h"
+#include "tls/random.h"
 
 TEST_CASE("RSA") {
     const rsa_class rsa{256};
@@ -14,3 +19,124 @@ TEST_CASE("RSA") {
     const auto b = rsa.sign(msg);
     REQUIRE(rsa.encode(b) == msg);
 }
+
+TEST_CASE("RSA key size") {
+    const rsa_class rsa = rsa_class::generate(1024);
+    REQUIRE(mpz_sizeinbase(rsa.K.get_mpz_t(), 2) == 1024);
+    const auto msg = mpz_class{"0x143214324234"};
+    REQUIRE(rsa.encode(rsa.sign(msg)) == msg);
+
+    // The constructor takes the size in bytes.
+    REQUIRE(mpz_sizeinbase(rsa_class{64}.K.get_mpz_t(), 2) == 512);
+}
+
+TEST_CASE("RSA public operation") {
+    // encode() runs on the Montgomery context of K.
+    const rsa_class rsa = rsa_class::generate(1024);
+    const mpz_class messages[] = {0, 1, 2, rsa.K - 1, random_below(rsa.K), random_below(rsa.K)};
+    for (const auto &m : messages)
+        REQUIRE(rsa.encode(m) == powm(m, rsa.e, rsa.K));
+}
+
+TEST_CASE("RSA CRT parameters") {
+    // Mersenne primes 2^127 - 1 and 2^107 - 1.
+    const mpz_class p = (mpz_class{1} << 127) - 1, q = (mpz_class{1} << 107) - 1, K = p * q, e = 65537;
+    mpz_class d, q_inv;
+    const mpz_class phi = lcm(p - 1, q - 1);
+    mpz_invert(d.get_mpz_t(), e.get_mpz_t(), phi.get_mpz_t());
+    mpz_invert(q_inv.get_mpz_t(), q.get_mpz_t(), p.get_mpz_t());
+    const mpz_class dp = d % (p - 1), dq = d % (q - 1);
+
+    const rsa_class plain{e, d, K};
+    const rsa_class crt{e, d, K, p, q, dp, dq, q_inv};
+    const mpz_class messages[] = {0, 1, 2, p, q, K - 1, mpz_class{"0x123456789abcdef"}};
+    for (const auto &m : messages) {
+        REQUIRE(crt.decode(m) == plain.decode(m));
+        REQUIRE(crt.encode(crt.sign(m)) == m);
+    }
+
+    REQUIRE_THROWS_AS(rsa_class(e, d, K, p, q + 2, dp, dq, q_inv), std::invalid_argument);
+    REQUIRE_THROWS_AS(rsa_class(e, d, K, p, q, dp + 1, dq, q_inv), std::invalid_argument);
+    REQUIRE_THROWS_AS(rsa_class(e, d, K, p, q, dp, dq, q_inv + 1), std::invalid_argument);
+}
+
+TEST_CASE("Multi-prime RSA") {
+    SECTION("Key generation") {
+        for (const unsigned primes : {3u, 4u}) {
+            const rsa_class rsa = rsa_class::generate(1024, primes);
+            REQUIRE(mpz_sizeinbase(rsa.K.get_mpz_t(), 2) == 1024);
+            const auto msg = mpz_class{"0x143214324234"};
+            REQUIRE(rsa.encode(rsa.sign(msg)) == msg);
+            REQUIRE(rsa.decode(rsa.encode(rsa.K - 2)) == rsa.K - 2);
+        }
+        REQUIRE_THROWS_AS(rsa_class::generate(1024, 1), std::invalid_argument);
+        REQUIRE_THROWS_AS(rsa_class::generate(1024, 5), std::invalid_argument);
+    }
+
+    SECTION("Imported CRT parameters") {
+        // Mersenne primes 2^127 - 1, 2^107 - 1, 2^89 - 1 and 2^61 - 1.
+        const mpz_class p = (mpz_class{1} << 127) - 1, q = (mpz_class{1} << 107) - 1;
+        const mpz_class r3 = (mpz_class{1} << 89) - 1, r4 = (mpz_class{1} << 61) - 1, K = p * q * r3 * r4, e = 65537;
+        mpz_class d, q_inv, t3, t4;
+        const mpz_class phi = lcm(lcm(p - 1, q - 1), lcm(r3 - 1, r4 - 1));
+        mpz_invert(d.get_mpz_t(), e.get_mpz_t(), phi.get_mpz_t());
+        mpz_invert(q_inv.get_mpz_t(), q.get_mpz_t(), p.get_mpz_t());
+        mpz_invert(t3.get_mpz_t(), mpz_class{p * q}.get_mpz_t(), r3.get_mpz_t());
+        mpz_invert(t4.get_mpz_t(), mpz_class{p * q * r3}.get_mpz_t(), r4.get_mpz_t());
+        const rsa_class::other_prime others[] = {{r3, d % (r3 - 1), t3}, {r4, d % (r4 - 1), t4}};
+
+        const rsa_class plain{e, d, K};
+        const rsa_class crt{e, d, K, p, q, d % (p - 1), d % (q - 1), q_inv, others};
+        const mpz_class messages[] = {0, 1, 2, p, r3, r4 * q, K - 1, mpz_class{"0x123456789abcdef0123456789"}};
+        for (const auto &m : messages) {
+            REQUIRE(crt.decode(m) == plain.decode(m));
+            REQUIRE(crt.encode(crt.sign(m)) == m);
+        }
+
+        std::vector bad(std::begin(others), std::end(others));
+        bad[1].t += 1;
+        REQUIRE_THROWS_AS(rsa_class(e, d, K, p, q, d % (p - 1), d % (q - 1), q_inv, bad), std::invalid_argument);
+        REQUIRE_THROWS_AS(rsa_class(e, d, K, p, q, d % (p - 1), d % (q - 1), q_inv, std::span{others, 1}),
+                          std::invalid_argument);
+    }
+}
+
+TEST_CASE("RSA private operation") {
+    rsa_class rsa = rsa_class::generate(1024, 3);
+
+    std::array<unsigned char, 128> msg{}, sig{}, sig2{};
+    for (size_t i = 1; i < msg.size(); ++i)
+        msg[i] = static_cast<unsigned char>(i * 7);
+    rsa.sign(msg, sig);
+    REQUIRE(bnd2mpz(std::span<const unsigned char>{sig}) == rsa.sign(std::span<const unsigned char>{msg}));
+    REQUIRE(rsa.encode(bnd2mpz(std::span<const unsigned char>{sig})) == bnd2mpz(std::span<const unsigned char>{msg}));
+    rsa.sign(std::span{msg}.subspan(100), sig2); // Shorter messages are zero-extended.
+    REQUIRE(rsa.encode(bnd2mpz(std::span<const unsigned char>{sig2})) ==
+            bnd2mpz(std::span<const unsigned char>{msg}.subspan(100)));
+
+    SECTION("Blinding") {
+        rsa.set_blinding(true);
+        for (int i = 0; i < 5; ++i) {
+            // The cached factors change after every call; the results must not.
+            rsa.sign(msg, sig2);
+            REQUIRE(sig2 == sig);
+            const mpz_class m = random_below(rsa.K);
+            REQUIRE(rsa.encode(rsa.decode(m)) == m);
+        }
+        const rsa_class copy = rsa; // Shares the factors
+        REQUIRE(copy.sign(mpz_class{12345}) == rsa.sign(mpz_class{12345}));
+        rsa.set_blinding(false);
+        rsa.sign(msg, sig2);
+        REQUIRE(sig2 == sig);
+    }
+
+    SECTION("Invalid arguments") {
+        std::array<unsigned char, 127> short_sig{};
+        REQUIRE_THROWS_AS(rsa.sign(msg, short_sig), std::invalid_argument);
+        std::array<unsigned char, 129> long_msg{};
+        REQUIRE_THROWS_AS(rsa.sign(long_msg, sig), std::invalid_argument);
+        msg.fill(0xff); // Not less than K
+        REQUIRE_THROWS_AS(rsa.sign(msg, sig), std::invalid_argument);
+        REQUIRE_THROWS_AS(rsa_class(3, 3, 100), std::invalid_argument);
+    }
+}
@@ -3,9 +3,11 @@
 //
 
 #include <catch2/catch_test_macros.hpp>
+#include <list>
 #include "tls/mpz.h"
 #include "tls/sha/sha1.h"
 #include "tls/sha/sha2.h"
+#include "tls/transcript_hash.h"
 
 TEST_CASE("SHA") {
     const std::string s[] = {// clang-format off
@@ -90,4 +92,51 @@ TEST_CASE("SHA") {
             }
         }
     }
+
+    SECTION("Incremental update") {
+        // Feed the message in chunks of every size so that block boundaries are crossed at every offset.
+        const std::string msg(1000, 'a');
+        const auto check = [&msg]<class Hash>(Hash sha) {
+            const auto expected = sha.hash(msg.begin(), msg.end());
+            for (size_t step = 1; step <= 130; ++step) {
+                for (size_t i = 0; i < msg.size(); i += step)
+                    sha.update(msg.begin() + i, msg.begin() + std::min(msg.size(), i + step));
+                REQUIRE(sha.digest() == expected);
+            }
+        };
+        check(sha1{});
+        check(sha256{});
+        check(sha512{});
+
+        // One million repetitions of 'a' (FIPS 180-2 test vector).
+        sha256 sha{};
+        unsigned char nresult[32];
+        mpz2bnd(mpz_class{"0xcdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"}, nresult, nresult + 32);
+        for (int i = 0; i < 1000; ++i)
+            sha.update(msg.begin(), msg.end());
+        auto a = sha.digest();
+        REQUIRE(std::equal(a.begin(), a.end(), nresult));
+
+        // Non-contiguous input goes through the byte-wise path.
+        const std::list<char> l{msg.begin(), msg.end()};
+        sha.update(l.begin(), l.end());
+        const auto b = sha.digest();
+        REQUIRE(b == sha.hash(msg.begin(), msg.end()));
+    }
+}
+
+TEST_CASE("Transcript hash") {
+    const std::string messages[] = {"client hello", "server hello", std::string(300, 'c'), "finished"};
+    transcript_hash<sha384> transcript;
+    sha384 sha{};
+    std::string history;
+    for (const auto &m : messages) {
+        transcript.update(m.begin(), m.end());
+        history += m;
+        // Intermediate digests match hashing the whole history and leave the running state intact.
+        REQUIRE(transcript.digest() == sha.hash(history.begin(), history.end()));
+        REQUIRE(transcript.digest() == sha.hash(history.begin(), history.end()));
+    }
+    transcript.reset();
+    REQUIRE(transcript.digest() == sha.hash(history.end(), history.end()));
 }
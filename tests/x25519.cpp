@@ -0,0 +1,60 @@
+//
+// Created by wtchr on 10/19/2026.
+//
+
+#include "tls/x25519.h"
+#include <catch2/catch_test_macros.hpp>
+#include <stdexcept>
+#include "tls/mpz.h"
+
+namespace {
+    x25519::key_type key(const char *hex) {
+        x25519::key_type k;
+        mpz2bnd(mpz_class{hex}, k.begin(), k.end());
+        return k;
+    }
+} // namespace
+
+TEST_CASE("X25519") {
+    SECTION("Scalar multiplication (RFC 7748, section 5.2)") {
+        REQUIRE(x25519::scalar_mult(key("0xa546e36bf0527c9d3b16154b82465edd62144c0ac1fc5a18506a2244ba449ac4"),
+                                    key("0xe6db6867583030db3594c1a424b15f7c726624ec26b3353b10a903a6d0ab1c4c")) ==
+                key("0xc3da55379de9c6908e94ea4df28d084f32eccf03491c71f754b4075577a28552"));
+        // The top bit of u is ignored.
+        REQUIRE(x25519::scalar_mult(key("0x4b66e9d4d1b4673c5ad22691957d6af5c11b6421e0ea01d42ca4169e7918ba0d"),
+                                    key("0xe5210f12786811d3f4b7959d0538ae2c31dbe7106fc03c3efc4cd549c715a493")) ==
+                key("0x95cbde9476e8907d7aade45cb4b873f88b595a68799fa152e6f8f7647aac7957"));
+    }
+
+    SECTION("Iterated scalar multiplication") {
+        x25519::key_type k = key("0x0900000000000000000000000000000000000000000000000000000000000000"), u = k;
+        for (int i = 0; i < 1000; ++i) {
+            const auto r = x25519::scalar_mult(k, u);
+            u = k;
+            k = r;
+            if (i == 0)
+                REQUIRE(k == key("0x422c8e7a6227d7bca1350b3e2bb7279f7897b87bb6854b783c60e80311ae3079"));
+        }
+        REQUIRE(k == key("0x684cf59ba83309552800ef566f2f4d3c1c3887c49360e3875f2eb94d99532c51"));
+    }
+
+    SECTION("Key exchange (RFC 7748, section 6.1)") {
+        x25519 alice{key("0x77076d0a7318a57d3c16c17251b26645df4c2f87ebc0992ab177fba51db92c2a")};
+        x25519 bob{key("0x5dab087e624a8a4b79e17f8b83800ee66f3bb1292618b6fd1c2f8b27ff88e0eb")};
+        REQUIRE(alice.y == key("0x8520f0098930a754748b7ddcb43ef75a0dbf3a0d26381af4eba4a98eaa9b4e6a"));
+        REQUIRE(bob.y == key("0xde9edb7d7b7dc1b4d35b61c2ece435373f8343c85b78674dadfc7e146f882b4f"));
+        const auto shared = key("0x4a5d9d5ba4ce2de1728e3bf480350f25e07e21c947d19e3376f09b3c1e161742");
+        REQUIRE(alice.set_peer_public_key(bob.y) == shared);
+        REQUIRE(bob.set_peer_public_key(alice.y) == shared);
+        REQUIRE(alice.K == bob.K);
+
+        x25519 c, d;
+        REQUIRE(c.set_peer_public_key(d.y) == d.set_peer_public_key(c.y));
+    }
+
+    SECTION("Small-order public keys") {
+        x25519 alice;
+        REQUIRE_THROWS_AS(alice.set_peer_public_key(x25519::key_type{}), std::invalid_argument);
+        REQUIRE_THROWS_AS(alice.set_peer_public_key(x25519::key_type{1}), std::invalid_argument);
+    }
+}
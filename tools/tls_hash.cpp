@@ -0,0 +1,291 @@
+//
+// Created by wtchr on 10/19/2026.
+//
+
+// tls-hash: computes or verifies file digests with the sha1/sha2 implementations of this library.
+//
+// Usage: tls-hash [-a ALGORITHM] [-j THREADS] [--stream] FILE...
+//        tls-hash [-a ALGORITHM] [-j THREADS] [--stream] -c CHECKSUM_FILE
+//
+// Output and checksum files use the same "<hex digest>  <path>" layout as sha256sum, so existing manifests can be
+// verified directly. Files are hashed concurrently; regular files are memory-mapped and fed to the compression
+// function in place, everything else (or every file with --stream) is read through a large aligned buffer.
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "tls/sha/sha1.h"
+#include "tls/sha/sha2.h"
+
+#ifdef _WIN32
+#define TLS_HASH_POSIX 0
+#else
+#define TLS_HASH_POSIX 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    constexpr size_t read_buffer_size = 1 << 20; ///< Size of one streaming read
+    constexpr size_t read_buffer_alignment = 4096; ///< Alignment of the streaming buffer (page size)
+
+    struct options {
+        bool stream = false; ///< Never mmap, always use buffered reads.
+        unsigned threads = 0; ///< Number of worker threads (0: hardware concurrency).
+    };
+
+    struct result {
+        std::string digest; ///< Hex digest, empty on failure.
+        std::string error; ///< Error message if the file could not be read.
+    };
+
+    using hash_fn = result (*)(const std::string &, const options &);
+
+    template<class C>
+    std::string to_hex(const C &c) {
+        static constexpr char digits[] = "0123456789abcdef";
+        std::string s;
+        s.reserve(c.size() * 2);
+        for (const unsigned char ch : c) {
+            s.push_back(digits[ch >> 4]);
+            s.push_back(digits[ch & 0xf]);
+        }
+        return s;
+    }
+
+    struct aligned_deleter {
+        void operator()(unsigned char *p) const {
+#ifdef _WIN32
+            _aligned_free(p);
+#else
+            std::free(p);
+#endif
+        }
+    };
+
+    std::unique_ptr<unsigned char, aligned_deleter> aligned_buffer() {
+#ifdef _WIN32
+        auto *p = static_cast<unsigned char *>(_aligned_malloc(read_buffer_size, read_buffer_alignment));
+#else
+        auto *p = static_cast<unsigned char *>(std::aligned_alloc(read_buffer_alignment, read_buffer_size));
+#endif
+        return std::unique_ptr<unsigned char, aligned_deleter>{p};
+    }
+
+    /**
+     * @brief Hashes a stream by reading it through a large aligned buffer.
+     */
+    template<class Hash>
+    result hash_stream(std::istream &is, Hash &h) {
+        const auto buf = aligned_buffer();
+        if (!buf)
+            return {{}, "out of memory"};
+        while (is) {
+            is.read(reinterpret_cast<char *>(buf.get()), read_buffer_size);
+            h.update(buf.get(), buf.get() + is.gcount());
+        }
+        if (is.bad())
+            return {{}, "read error"};
+        return {to_hex(h.digest()), {}};
+    }
+
+#if TLS_HASH_POSIX
+    /**
+     * @brief Hashes an open file descriptor with buffered reads.
+     */
+    template<class Hash>
+    result hash_fd(const int fd, Hash &h) {
+        const auto buf = aligned_buffer();
+        if (!buf)
+            return {{}, "out of memory"};
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        for (;;) {
+            const ssize_t n = read(fd, buf.get(), read_buffer_size);
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                return {{}, std::strerror(errno)};
+            }
+            if (n == 0)
+                break;
+            h.update(buf.get(), buf.get() + n);
+        }
+        return {to_hex(h.digest()), {}};
+    }
+#endif
+
+    template<class Hash>
+    result hash_file(const std::string &path, const options &opt) {
+        Hash h;
+        if (path == "-")
+            return hash_stream(std::cin, h);
+#if TLS_HASH_POSIX
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return {{}, std::strerror(errno)};
+        struct stat st{};
+        if (fstat(fd, &st) < 0) {
+            const int err = errno;
+            close(fd);
+            return {{}, std::strerror(err)};
+        }
+        result r;
+        void *m = MAP_FAILED;
+        if (!opt.stream && S_ISREG(st.st_mode) && st.st_size > 0)
+            m = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (m != MAP_FAILED) {
+            madvise(m, st.st_size, MADV_SEQUENTIAL);
+            const auto *p = static_cast<const unsigned char *>(m);
+            h.update(p, p + st.st_size);
+            r = {to_hex(h.digest()), {}};
+            munmap(m, st.st_size);
+        } else {
+            // Not mappable (pipe, device, empty file) or streaming was requested.
+            r = hash_fd(fd, h);
+        }
+        close(fd);
+        return r;
+#else
+        std::ifstream is{path, std::ios::binary};
+        if (!is)
+            return {{}, "cannot open file"};
+        return hash_stream(is, h);
+#endif
+    }
+
+    hash_fn find_algorithm(const std::string_view name) {
+        if (name == "sha1")
+            return hash_file<sha1>;
+        if (name == "sha224")
+            return hash_file<sha224>;
+        if (name == "sha256")
+            return hash_file<sha256>;
+        if (name == "sha384")
+            return hash_file<sha384>;
+        if (name == "sha512")
+            return hash_file<sha512>;
+        return nullptr;
+    }
+
+    /**
+     * @brief Hashes all files on a pool of worker threads. Results are returned in input order.
+     */
+    std::vector<result> hash_all(const std::vector<std::string> &paths, const hash_fn fn, const options &opt) {
+        std::vector<result> results(paths.size());
+        std::atomic<size_t> next{0};
+        auto worker = [&] {
+            for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < paths.size();)
+                results[i] = fn(paths[i], opt);
+        };
+        unsigned n = opt.threads ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+        n = static_cast<unsigned>(std::min<size_t>(n, paths.size()));
+        std::vector<std::thread> pool;
+        for (unsigned i = 1; i < n; ++i)
+            pool.emplace_back(worker);
+        worker();
+        for (auto &t : pool)
+            t.join();
+        return results;
+    }
+
+    int usage(const char *prog) {
+        std::cerr << "Usage: " << prog << " [-a sha1|sha224|sha256|sha384|sha512] [-j THREADS] [--stream] FILE...\n"
+                  << "       " << prog << " [-a ALGORITHM] [-j THREADS] [--stream] -c CHECKSUM_FILE\n";
+        return 2;
+    }
+} // namespace
+
+int main(int argc, char *argv[]) {
+    options opt;
+    hash_fn fn = hash_file<sha256>;
+    std::string check_file;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if ((arg == "-a" || arg == "-j" || arg == "-c") && i + 1 >= argc)
+            return usage(argv[0]);
+        if (arg == "-a") {
+            if (!(fn = find_algorithm(argv[++i]))) {
+                std::cerr << "unknown algorithm: " << argv[i] << '\n';
+                return 2;
+            }
+        } else if (arg == "-j") {
+            opt.threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "-c") {
+            check_file = argv[++i];
+        } else if (arg == "--stream") {
+            opt.stream = true;
+        } else if (arg == "-h" || arg == "--help") {
+            usage(argv[0]);
+            return 0;
+        } else {
+            paths.emplace_back(arg);
+        }
+    }
+
+    if (check_file.empty()) {
+        if (paths.empty())
+            return usage(argv[0]);
+        const auto results = hash_all(paths, fn, opt);
+        int status = 0;
+        for (size_t i = 0; i < paths.size(); ++i) {
+            if (results[i].error.empty()) {
+                std::cout << results[i].digest << "  " << paths[i] << '\n';
+            } else {
+                std::cerr << paths[i] << ": " << results[i].error << '\n';
+                status = 1;
+            }
+        }
+        return status;
+    }
+
+    // Verify mode: the files to check come only from the checksum file.
+    if (!paths.empty())
+        return usage(argv[0]);
+
+    // Each line is "<hex digest>  <path>" (a '*' before the path marks binary mode and is ignored).
+    std::ifstream is{check_file};
+    if (!is) {
+        std::cerr << check_file << ": cannot open file\n";
+        return 2;
+    }
+    std::vector<std::string> expected;
+    for (std::string line; std::getline(is, line);) {
+        const size_t sp = line.find(' ');
+        if (line.empty() || sp == std::string::npos || sp + 2 > line.size())
+            continue;
+        expected.push_back(line.substr(0, sp));
+        paths.push_back(line.substr(line[sp + 1] == ' ' || line[sp + 1] == '*' ? sp + 2 : sp + 1));
+    }
+    const auto results = hash_all(paths, fn, opt);
+    int status = 0;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        std::string digest = expected[i];
+        for (auto &c : digest)
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        if (!results[i].error.empty()) {
+            std::cout << paths[i] << ": FAILED open or read (" << results[i].error << ")\n";
+            status = 1;
+        } else if (results[i].digest != digest) {
+            std::cout << paths[i] << ": FAILED\n";
+            status = 1;
+        } else {
+            std::cout << paths[i] << ": OK\n";
+        }
+    }
+    return status;
+}